@@ -73,6 +73,15 @@ extern "C" {
  */
 struct isl_stats {
 	long	gbr_solved_lps;
+	long	gist_cache_hits;
+	long	gist_cache_misses;
+	long	lexopt_cache_hits;
+	long	lexopt_cache_misses;
+	long	pip_compression_hits;
+	long	pip_compression_misses;
+	long	schedule_coef_hits;
+	long	schedule_coef_misses;
+	long	tab_pivots;
 };
 enum isl_error {
 	isl_error_none = 0,
@@ -179,6 +188,9 @@ void isl_ctx_set_max_operations(isl_ctx *ctx, unsigned long max_operations);
 unsigned long isl_ctx_get_max_operations(isl_ctx *ctx);
 void isl_ctx_reset_operations(isl_ctx *ctx);
 
+isl_stat isl_ctx_push_region(isl_ctx *ctx);
+isl_stat isl_ctx_pop_region(isl_ctx *ctx);
+
 #define ISL_ARG_CTX_DECL(prefix,st,args)				\
 st *isl_ctx_peek_ ## prefix(isl_ctx *ctx);
 
@@ -43,6 +43,28 @@ int isl_options_get_schedule_algorithm(isl_ctx *ctx);
 isl_stat isl_options_set_coalesce_bounded_wrapping(isl_ctx *ctx, int val);
 int isl_options_get_coalesce_bounded_wrapping(isl_ctx *ctx);
 
+isl_stat isl_options_set_share_basic_maps(isl_ctx *ctx, int val);
+int isl_options_get_share_basic_maps(isl_ctx *ctx);
+
+isl_stat isl_options_set_gist_cache_size(isl_ctx *ctx, int val);
+int isl_options_get_gist_cache_size(isl_ctx *ctx);
+
+isl_stat isl_options_set_lexopt_cache_size(isl_ctx *ctx, int val);
+int isl_options_get_lexopt_cache_size(isl_ctx *ctx);
+
+isl_stat isl_options_set_pip_compress(isl_ctx *ctx, int val);
+int isl_options_get_pip_compress(isl_ctx *ctx);
+
+#define			ISL_LP_TAB		0
+#define			ISL_LP_FLOAT		1
+isl_stat isl_options_set_lp_solver(isl_ctx *ctx, int val);
+int isl_options_get_lp_solver(isl_ctx *ctx);
+
+#define			ISL_ILP_SEARCH		0
+#define			ISL_ILP_BB		1
+isl_stat isl_options_set_ilp_solver(isl_ctx *ctx, int val);
+int isl_options_get_ilp_solver(isl_ctx *ctx);
+
 #if defined(__cplusplus)
 }
 #endif
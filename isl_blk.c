@@ -10,9 +10,6 @@
 #include <isl_blk.h>
 #include <isl_ctx_private.h>
 
-/* The maximal number of cache misses before first element is evicted */
-#define ISL_BLK_MAX_MISS	100
-
 struct isl_blk isl_blk_empty()
 {
 	struct isl_blk block;
@@ -71,37 +68,48 @@ static void isl_blk_free_force(struct isl_ctx *ctx, struct isl_blk block)
 	free(block.data);
 }
 
+/* Return the size class of a block of size "size",
+ * i.e., the largest "c" such that 2^c <= size.
+ */
+static int size_class(size_t size)
+{
+	int c = 0;
+
+	while (size >>= 1)
+		++c;
+	return c;
+}
+
+/* Return a block of size at least "n".
+ *
+ * Any block in size class "c" with 2^(c-1) < n <= 2^c is large enough,
+ * so a cached block can be taken from this size class without
+ * any search.  If there is no such block, then a new block
+ * of size 2^c is allocated such that it can be reused
+ * for any request in the same size class once it gets freed.
+ * Requests that are too large to be cached are allocated exactly.
+ */
 struct isl_blk isl_blk_alloc(struct isl_ctx *ctx, size_t n)
 {
-	int i;
+	int c;
 	struct isl_blk block;
 
 	block = isl_blk_empty();
-	if (n && ctx->n_cached) {
-		int best = 0;
-		for (i = 1; ctx->cache[best].size != n && i < ctx->n_cached; ++i) {
-			if (ctx->cache[best].size < n) {
-				if (ctx->cache[i].size > ctx->cache[best].size)
-					best = i;
-			} else if (ctx->cache[i].size >= n &&
-				   ctx->cache[i].size < ctx->cache[best].size)
-					best = i;
-		}
-		if (ctx->cache[best].size < 2 * n + 100) {
-			block = ctx->cache[best];
-			if (--ctx->n_cached != best)
-				ctx->cache[best] = ctx->cache[ctx->n_cached];
-			if (best == 0)
-				ctx->n_miss = 0;
-		} else if (ctx->n_miss++ >= ISL_BLK_MAX_MISS) {
-			isl_blk_free_force(ctx, ctx->cache[0]);
-			if (--ctx->n_cached != 0)
-				ctx->cache[0] = ctx->cache[ctx->n_cached];
-			ctx->n_miss = 0;
-		}
+	if (n == 0)
+		return block;
+
+	c = n == 1 ? 0 : size_class(n - 1) + 1;
+	if (c >= ISL_BLK_N_CLASS) {
+		ctx->n_blk_miss++;
+		return extend(ctx, block, n);
+	}
+	if (ctx->n_cached[c] > 0) {
+		ctx->n_blk_hit++;
+		return ctx->cache[c][--ctx->n_cached[c]];
 	}
 
-	return extend(ctx, block, n);
+	ctx->n_blk_miss++;
+	return extend(ctx, block, (size_t) 1 << c);
 }
 
 struct isl_blk isl_blk_extend(struct isl_ctx *ctx, struct isl_blk block,
@@ -113,22 +121,46 @@ struct isl_blk isl_blk_extend(struct isl_ctx *ctx, struct isl_blk block,
 	return extend(ctx, block, new_n);
 }
 
+/* Release "block", keeping it in the cache of its size class
+ * if this cache is not full yet.
+ * Inside a region, more blocks are kept in the cache.
+ */
 void isl_blk_free(struct isl_ctx *ctx, struct isl_blk block)
 {
+	int c;
+	int max;
+
 	if (isl_blk_is_empty(block) || isl_blk_is_error(block))
 		return;
 
-	if (ctx->n_cached < ISL_BLK_CACHE_SIZE)
-		ctx->cache[ctx->n_cached++] = block;
+	max = ctx->n_region ? ISL_BLK_REGION_CACHE_SIZE : ISL_BLK_CACHE_SIZE;
+	c = size_class(block.size);
+	if (c < ISL_BLK_N_CLASS && ctx->n_cached[c] < max)
+		ctx->cache[c][ctx->n_cached[c]++] = block;
 	else
 		isl_blk_free_force(ctx, block);
 }
 
 void isl_blk_clear_cache(struct isl_ctx *ctx)
 {
-	int i;
+	int c, i;
+
+	for (c = 0; c < ISL_BLK_N_CLASS; ++c) {
+		for (i = 0; i < ctx->n_cached[c]; ++i)
+			isl_blk_free_force(ctx, ctx->cache[c][i]);
+		ctx->n_cached[c] = 0;
+	}
+}
+
+/* Release the cached blocks beyond the ISL_BLK_CACHE_SIZE
+ * that may be kept in each size class outside of a region.
+ */
+void isl_blk_trim_cache(struct isl_ctx *ctx)
+{
+	int c;
 
-	for (i = 0; i < ctx->n_cached; ++i)
-		isl_blk_free_force(ctx, ctx->cache[i]);
-	ctx->n_cached = 0;
+	for (c = 0; c < ISL_BLK_N_CLASS; ++c)
+		while (ctx->n_cached[c] > ISL_BLK_CACHE_SIZE)
+			isl_blk_free_force(ctx,
+					ctx->cache[c][--ctx->n_cached[c]]);
 }
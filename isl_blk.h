@@ -21,7 +21,15 @@ struct isl_blk {
 	isl_int *data;
 };
 
-#define ISL_BLK_CACHE_SIZE	20
+/* Blocks are cached per size class.  A block of size "size"
+ * belongs to size class "c" if 2^c <= size < 2^(c+1).
+ * Only blocks of size smaller than 2^ISL_BLK_N_CLASS are cached and
+ * at most ISL_BLK_CACHE_SIZE blocks are cached per size class,
+ * or ISL_BLK_REGION_CACHE_SIZE blocks inside a region.
+ */
+#define ISL_BLK_N_CLASS			16
+#define ISL_BLK_CACHE_SIZE		4
+#define ISL_BLK_REGION_CACHE_SIZE	64
 
 struct isl_ctx;
 
@@ -32,6 +40,7 @@ struct isl_blk isl_blk_extend(struct isl_ctx *ctx, struct isl_blk block,
 				size_t new_n);
 void isl_blk_free(struct isl_ctx *ctx, struct isl_blk block);
 void isl_blk_clear_cache(struct isl_ctx *ctx);
+void isl_blk_trim_cache(struct isl_ctx *ctx);
 
 #if defined(__cplusplus)
 }
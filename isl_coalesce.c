@@ -153,6 +153,10 @@ static int all(int *con, unsigned len, int status)
  * "bmap" is the basic map itself (or NULL if "removed" is set)
  * "tab" is the corresponding tableau (or NULL if "removed" is set)
  * "hull_hash" identifies the affine space in which "bmap" lives.
+ * "separator" is the position of an inequality of "bmap" that
+ * was found to separate "bmap" from some other basic map (or -1).
+ * It is only used as a hint for quickly detecting that "bmap" is
+ * also separated from other basic maps by the same inequality.
  * "removed" is set if this basic map has been removed from the map
  * "simplify" is set if this basic map may have some unknown integer
  * divisions that were not present in the input basic maps.  The basic
@@ -170,6 +174,7 @@ struct isl_coalesce_info {
 	isl_basic_map *bmap;
 	struct isl_tab *tab;
 	uint32_t hull_hash;
+	int separator;
 	int removed;
 	int simplify;
 	int *eq;
@@ -238,6 +243,47 @@ static void exchange(struct isl_coalesce_info *info1,
 	*info2 = info;
 }
 
+/* Is the basic map represented by "info_i" separated from
+ * the basic map represented by "info_j" by the inequality
+ * that was found to separate "info_i" from some other basic map?
+ *
+ * The inequality is only considered if it is not redundant
+ * in "info_i", as is done in ineq_status_in.
+ * If so, ineq_status_in would also have found this inequality
+ * to be separating and coalesce_local_pair would not have
+ * made any changes.
+ */
+static int separated_by_hint(struct isl_coalesce_info *info_i,
+	struct isl_coalesce_info *info_j)
+{
+	int k = info_i->separator;
+	unsigned n_eq = info_i->bmap->n_eq;
+
+	if (k < 0 || k >= info_i->bmap->n_ineq)
+		return 0;
+	if (isl_tab_is_redundant(info_i->tab, n_eq + k))
+		return 0;
+	switch (status_in(info_i->bmap->ineq[k], info_j->tab)) {
+	case STATUS_ERROR:	return -1;
+	case STATUS_SEPARATE:	return 1;
+	default:		return 0;
+	}
+}
+
+/* Record the position of the separating inequality in "ineq", if any,
+ * as a hint for future calls to separated_by_hint.
+ */
+static void set_separator(struct isl_coalesce_info *info, int *ineq)
+{
+	int k;
+
+	for (k = 0; k < info->bmap->n_ineq; ++k)
+		if (ineq[k] == STATUS_SEPARATE) {
+			info->separator = k;
+			return;
+		}
+}
+
 /* This type represents the kind of change that has been performed
  * while trying to coalesce two basic maps.
  *
@@ -426,6 +472,7 @@ static enum isl_change fuse(int i, int j, struct isl_coalesce_info *info,
 	info[i].bmap = fused;
 	isl_tab_free(info[i].tab);
 	info[i].tab = fused_tab;
+	info[i].separator = -1;
 	drop(&info[j]);
 
 	return isl_change_fuse;
@@ -1586,6 +1633,12 @@ unbounded:
  *	   such sets can always be combined through wrapping, but we impose
  *	   that there is only one such pair, to avoid overeager coalescing.
  *
+ * Before computing the status of all inequalities, we first check
+ * if the inequality that was last found to separate either basic map
+ * from some other basic map also separates it from the current one.
+ * In a map with many disjuncts, most pairs are separated and
+ * a single inequality typically separates a basic map from many others.
+ *
  * Throughout the computation, we maintain a collection of tableaus
  * corresponding to the basic maps.  When the basic maps are dropped
  * or combined, the tableaus are modified accordingly.
@@ -1593,6 +1646,7 @@ unbounded:
 static enum isl_change coalesce_local_pair(int i, int j,
 	struct isl_coalesce_info *info)
 {
+	int separated;
 	enum isl_change change = isl_change_none;
 
 	info[i].eq = info[i].ineq = NULL;
@@ -1614,21 +1668,33 @@ static enum isl_change coalesce_local_pair(int i, int j,
 	if (any(info[j].eq, 2 * info[j].bmap->n_eq, STATUS_SEPARATE))
 		goto done;
 
+	separated = separated_by_hint(&info[i], &info[j]);
+	if (separated >= 0 && !separated)
+		separated = separated_by_hint(&info[j], &info[i]);
+	if (separated < 0)
+		goto error;
+	if (separated)
+		goto done;
+
 	info[i].ineq = ineq_status_in(info[i].bmap, info[i].tab, info[j].tab);
 	if (info[i].bmap->n_ineq && !info[i].ineq)
 		goto error;
 	if (any(info[i].ineq, info[i].bmap->n_ineq, STATUS_ERROR))
 		goto error;
-	if (any(info[i].ineq, info[i].bmap->n_ineq, STATUS_SEPARATE))
+	if (any(info[i].ineq, info[i].bmap->n_ineq, STATUS_SEPARATE)) {
+		set_separator(&info[i], info[i].ineq);
 		goto done;
+	}
 
 	info[j].ineq = ineq_status_in(info[j].bmap, info[j].tab, info[i].tab);
 	if (info[j].bmap->n_ineq && !info[j].ineq)
 		goto error;
 	if (any(info[j].ineq, info[j].bmap->n_ineq, STATUS_ERROR))
 		goto error;
-	if (any(info[j].ineq, info[j].bmap->n_ineq, STATUS_SEPARATE))
+	if (any(info[j].ineq, info[j].bmap->n_ineq, STATUS_SEPARATE)) {
+		set_separator(&info[j], info[j].ineq);
 		goto done;
+	}
 
 	if (all(info[i].eq, 2 * info[i].bmap->n_eq, STATUS_VALID) &&
 	    all(info[i].ineq, info[i].bmap->n_ineq, STATUS_VALID)) {
@@ -2639,6 +2705,7 @@ struct isl_map *isl_map_coalesce(struct isl_map *map)
 		map->p[i] = isl_basic_map_reduce_coefficients(map->p[i]);
 		if (!map->p[i])
 			goto error;
+		info[i].separator = -1;
 		info[i].bmap = isl_basic_map_copy(map->p[i]);
 		info[i].tab = isl_tab_from_basic_map(info[i].bmap, 0);
 		if (!info[i].tab)
@@ -143,6 +143,55 @@ void *isl_ctx_peek_options(isl_ctx *ctx, struct isl_args *args)
 	return find_nested_options(ctx->user_args, ctx->user_opt, args);
 }
 
+#ifdef USE_THREAD_SAFE_ID
+
+/* Initialize the lock that protects the id table of "ctx".
+ */
+static int init_id_lock(isl_ctx *ctx)
+{
+	if (pthread_mutex_init(&ctx->id_lock, NULL) != 0)
+		return -1;
+	return 0;
+}
+
+static void destroy_id_lock(isl_ctx *ctx)
+{
+	pthread_mutex_destroy(&ctx->id_lock);
+}
+
+/* Acquire exclusive access to the id table of "ctx".
+ */
+void isl_ctx_lock_id_table(isl_ctx *ctx)
+{
+	pthread_mutex_lock(&ctx->id_lock);
+}
+
+void isl_ctx_unlock_id_table(isl_ctx *ctx)
+{
+	pthread_mutex_unlock(&ctx->id_lock);
+}
+
+#else
+
+static int init_id_lock(isl_ctx *ctx)
+{
+	return 0;
+}
+
+static void destroy_id_lock(isl_ctx *ctx)
+{
+}
+
+void isl_ctx_lock_id_table(isl_ctx *ctx)
+{
+}
+
+void isl_ctx_unlock_id_table(isl_ctx *ctx)
+{
+}
+
+#endif
+
 isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 {
 	struct isl_ctx *ctx = NULL;
@@ -166,6 +215,10 @@ isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 
 	if (isl_hash_table_init(ctx, &ctx->id_table, 0))
 		goto error;
+	if (isl_hash_table_init(ctx, &ctx->bmap_table, 0))
+		goto error;
+	if (init_id_lock(ctx) < 0)
+		goto error;
 
 	ctx->stats = isl_calloc_type(ctx, struct isl_stats);
 	if (!ctx->stats)
@@ -191,8 +244,9 @@ isl_ctx *isl_ctx_alloc_with_options(struct isl_args *args, void *user_opt)
 
 	isl_int_init(ctx->normalize_gcd);
 
-	ctx->n_cached = 0;
-	ctx->n_miss = 0;
+	ctx->n_region = 0;
+	ctx->n_blk_hit = 0;
+	ctx->n_blk_miss = 0;
 
 	ctx->error = isl_error_none;
 
@@ -219,13 +273,13 @@ struct isl_ctx *isl_ctx_alloc()
 
 void isl_ctx_ref(struct isl_ctx *ctx)
 {
-	ctx->ref++;
+	isl_ref_inc(ctx->ref);
 }
 
 void isl_ctx_deref(struct isl_ctx *ctx)
 {
 	isl_assert(ctx, ctx->ref > 0, return);
-	ctx->ref--;
+	isl_ref_dec(ctx->ref);
 }
 
 /* Print statistics on usage.
@@ -233,12 +287,34 @@ void isl_ctx_deref(struct isl_ctx *ctx)
 static void print_stats(isl_ctx *ctx)
 {
 	fprintf(stderr, "operations: %lu\n", ctx->operations);
+	fprintf(stderr, "block cache hits: %lu\n", ctx->n_blk_hit);
+	fprintf(stderr, "block cache misses: %lu\n", ctx->n_blk_miss);
+	fprintf(stderr, "gist cache hits: %ld\n", ctx->stats->gist_cache_hits);
+	fprintf(stderr, "gist cache misses: %ld\n",
+		ctx->stats->gist_cache_misses);
+	fprintf(stderr, "lexopt cache hits: %ld\n",
+		ctx->stats->lexopt_cache_hits);
+	fprintf(stderr, "lexopt cache misses: %ld\n",
+		ctx->stats->lexopt_cache_misses);
+	fprintf(stderr, "pip compression hits: %ld\n",
+		ctx->stats->pip_compression_hits);
+	fprintf(stderr, "pip compression misses: %ld\n",
+		ctx->stats->pip_compression_misses);
+	fprintf(stderr, "schedule coefficient hits: %ld\n",
+		ctx->stats->schedule_coef_hits);
+	fprintf(stderr, "schedule coefficient misses: %ld\n",
+		ctx->stats->schedule_coef_misses);
+	fprintf(stderr, "tableau pivots: %ld\n", ctx->stats->tab_pivots);
 }
 
 void isl_ctx_free(struct isl_ctx *ctx)
 {
 	if (!ctx)
 		return;
+	isl_ctx_clear_gist_cache(ctx);
+	isl_ctx_clear_lexopt_cache(ctx);
+	isl_ctx_clear_pip_compression(ctx);
+	isl_ctx_clear_schedule_cache(ctx);
 	if (ctx->ref != 0)
 		isl_die(ctx, isl_error_invalid,
 			"isl_ctx freed, but some objects still reference it",
@@ -248,6 +324,8 @@ void isl_ctx_free(struct isl_ctx *ctx)
 		print_stats(ctx);
 
 	isl_hash_table_clear(&ctx->id_table);
+	isl_hash_table_clear(&ctx->bmap_table);
+	destroy_id_lock(ctx);
 	isl_blk_clear_cache(ctx);
 	isl_int_clear(ctx->zero);
 	isl_int_clear(ctx->one);
@@ -332,3 +410,34 @@ void isl_ctx_reset_operations(isl_ctx *ctx)
 		return;
 	ctx->operations = 0;
 }
+
+/* Enter a (nested) region of "ctx".
+ * Inside a region, memory blocks of temporary objects are kept around
+ * after they are freed such that they can be reused without
+ * going through the system allocator.
+ */
+isl_stat isl_ctx_push_region(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	ctx->n_region++;
+	return isl_stat_ok;
+}
+
+/* Leave the innermost region of "ctx".
+ * If this was the outermost region, then the memory blocks kept around
+ * inside the region are released in one go.
+ * Objects that were created inside the region and that are still
+ * referenced are not affected.
+ */
+isl_stat isl_ctx_pop_region(isl_ctx *ctx)
+{
+	if (!ctx)
+		return isl_stat_error;
+	if (ctx->n_region <= 0)
+		isl_die(ctx, isl_error_invalid, "no region to pop",
+			return isl_stat_error);
+	if (--ctx->n_region == 0)
+		isl_blk_trim_cache(ctx);
+	return isl_stat_ok;
+}
@@ -1,6 +1,41 @@
 #include <isl/ctx.h>
 #include <isl_blk.h>
 
+#ifdef USE_THREAD_SAFE_ID
+#include <pthread.h>
+#endif
+
+/* An entry in the cache of results of isl_map_gist.
+ * "gist" is the gist of "map" with respect to "context" and
+ * "hash" combines the hash values of "map" and "context".
+ */
+struct isl_gist_cache_entry {
+	uint32_t	hash;
+	struct isl_map	*map;
+	struct isl_map	*context;
+	struct isl_map	*gist;
+};
+
+/* An entry in the cache of results of parametric lexicographic
+ * optimization.
+ * The result is the lexicographic minimum (or maximum if "max" is set)
+ * of "bmap" over "dom", stored in "map" or in "pma" (the other is NULL),
+ * depending on the kind of result that was requested.
+ * "empty" contains the part of "dom" without solutions or
+ * is NULL if it was not requested.
+ * "bmap" and "dom" are normalized and "hash" combines their hash values.
+ * Like the entries of the gist cache, the sets are stored as maps.
+ */
+struct isl_lexopt_cache_entry {
+	uint32_t			hash;
+	int				max;
+	struct isl_basic_map		*bmap;
+	struct isl_basic_map		*dom;
+	struct isl_map			*map;
+	struct isl_pw_multi_aff		*pma;
+	struct isl_map			*empty;
+};
+
 struct isl_ctx {
 	int			ref;
 
@@ -18,10 +53,24 @@ struct isl_ctx {
 
 	isl_int			normalize_gcd;
 
-	int			n_cached;
-	int			n_miss;
-	struct isl_blk		cache[ISL_BLK_CACHE_SIZE];
+	int			n_region;
+	int			n_cached[ISL_BLK_N_CLASS];
+	struct isl_blk		cache[ISL_BLK_N_CLASS][ISL_BLK_REGION_CACHE_SIZE];
+	unsigned long		n_blk_hit;
+	unsigned long		n_blk_miss;
 	struct isl_hash_table	id_table;
+	struct isl_hash_table	bmap_table;
+	int			n_gist_cache;
+	struct isl_gist_cache_entry	*gist_cache;
+	int			n_lexopt_cache;
+	struct isl_lexopt_cache_entry	*lexopt_cache;
+	struct isl_basic_map	*pip_compression_dom;
+	struct isl_morph	*pip_compression;
+	int			n_schedule_coef;
+	struct isl_map_to_basic_set	*schedule_coef;
+#ifdef USE_THREAD_SAFE_ID
+	pthread_mutex_t		id_lock;
+#endif
 
 	enum isl_error		error;
 
@@ -32,3 +81,23 @@ struct isl_ctx {
 };
 
 int isl_ctx_next_operation(isl_ctx *ctx);
+
+/* Increment or decrement the reference count "ref" and
+ * return the new value.  If isl was configured with thread-safe
+ * isl_id objects, then this is performed atomically.
+ */
+#ifdef USE_THREAD_SAFE_ID
+#define isl_ref_inc(ref)	__atomic_add_fetch(&(ref), 1, __ATOMIC_RELAXED)
+#define isl_ref_dec(ref)	__atomic_sub_fetch(&(ref), 1, __ATOMIC_ACQ_REL)
+#else
+#define isl_ref_inc(ref)	(++(ref))
+#define isl_ref_dec(ref)	(--(ref))
+#endif
+
+void isl_ctx_clear_gist_cache(isl_ctx *ctx);
+void isl_ctx_clear_lexopt_cache(isl_ctx *ctx);
+void isl_ctx_clear_pip_compression(isl_ctx *ctx);
+void isl_ctx_clear_schedule_cache(isl_ctx *ctx);
+
+void isl_ctx_lock_id_table(isl_ctx *ctx);
+void isl_ctx_unlock_id_table(isl_ctx *ctx);
@@ -96,11 +96,19 @@ static int isl_id_has_name_and_user(const void *entry, const void *val)
 	return !strcmp(id->name, nu->name);
 }
 
+/* Return the isl_id with the given name and user pointer,
+ * creating it if it does not exist yet.
+ *
+ * The id table is locked during the lookup such that
+ * the same isl_id is returned to concurrent callers
+ * if isl was configured with thread-safe isl_id objects.
+ */
 __isl_give isl_id *isl_id_alloc(isl_ctx *ctx, const char *name, void *user)
 {
 	struct isl_hash_table_entry *entry;
 	uint32_t id_hash;
 	struct isl_name_and_user nu = { name, user };
+	isl_id *id;
 
 	if (!ctx)
 		return NULL;
@@ -110,16 +118,21 @@ __isl_give isl_id *isl_id_alloc(isl_ctx *ctx, const char *name, void *user)
 		id_hash = isl_hash_string(id_hash, name);
 	else
 		id_hash = isl_hash_builtin(id_hash, user);
+	isl_ctx_lock_id_table(ctx);
 	entry = isl_hash_table_find(ctx, &ctx->id_table, id_hash,
 					isl_id_has_name_and_user, &nu, 1);
 	if (!entry)
-		return NULL;
-	if (entry->data)
-		return isl_id_copy(entry->data);
-	entry->data = id_alloc(ctx, name, user);
-	if (!entry->data)
-		ctx->id_table.n--;
-	return entry->data;
+		id = NULL;
+	else if (entry->data)
+		id = isl_id_copy(entry->data);
+	else {
+		entry->data = id_alloc(ctx, name, user);
+		if (!entry->data)
+			ctx->id_table.n--;
+		id = entry->data;
+	}
+	isl_ctx_unlock_id_table(ctx);
+	return id;
 }
 
 /* If the id has a negative refcount, then it is a static isl_id
@@ -133,7 +146,7 @@ __isl_give isl_id *isl_id_copy(isl_id *id)
 	if (id->ref < 0)
 		return id;
 
-	id->ref++;
+	isl_ref_inc(id->ref);
 	return id;
 }
 
@@ -192,6 +205,10 @@ __isl_give isl_id *isl_id_set_free_user(__isl_take isl_id *id,
 
 /* If the id has a negative refcount, then it is a static isl_id
  * and should not be freed.
+ *
+ * The reference count is decremented while the id table is locked
+ * such that a concurrent isl_id_alloc cannot pick up the isl_id
+ * after its last reference has been dropped.
  */
 __isl_null isl_id *isl_id_free(__isl_take isl_id *id)
 {
@@ -203,8 +220,11 @@ __isl_null isl_id *isl_id_free(__isl_take isl_id *id)
 	if (id->ref < 0)
 		return NULL;
 
-	if (--id->ref > 0)
+	isl_ctx_lock_id_table(id->ctx);
+	if (isl_ref_dec(id->ref) > 0) {
+		isl_ctx_unlock_id_table(id->ctx);
 		return NULL;
+	}
 
 	entry = isl_hash_table_find(id->ctx, &id->ctx->id_table, id->hash,
 					isl_id_eq, id, 0);
@@ -213,6 +233,7 @@ __isl_null isl_id *isl_id_free(__isl_take isl_id *id)
 			"unable to find id", (void)0);
 	else
 		isl_hash_table_remove(id->ctx, &id->ctx->id_table, entry);
+	isl_ctx_unlock_id_table(id->ctx);
 
 	if (id->free_user)
 		id->free_user(id->user);
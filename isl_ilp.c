@@ -11,6 +11,7 @@
 #include <isl_map_private.h>
 #include <isl/ilp.h>
 #include "isl_sample.h"
+#include "isl_tab.h"
 #include <isl_seq.h>
 #include "isl_equalities.h"
 #include <isl_aff_private.h>
@@ -20,6 +21,7 @@
 #include <isl_vec_private.h>
 #include <isl_lp_private.h>
 #include <isl_ilp_private.h>
+#include <isl_options_private.h>
 #include <isl/deprecated/ilp_int.h>
 
 /* Given a basic set "bset", construct a basic set U such that for
@@ -259,6 +261,334 @@ static enum isl_lp_result solve_ilp(struct isl_basic_set *bset,
 	return res;
 }
 
+#define ISL_ILP_BB_MAX_NODES	1000
+
+/* A node in the branch-and-bound tree of solve_ilp_bb.
+ * "parent" is the position of the parent node or -1 for the root.
+ * The node is obtained from its parent by imposing the constraint
+ * x_pos <= bound if "upper" is set and x_pos >= bound otherwise.
+ * "lower" is a lower bound on the value of the objective function
+ * over the integer points in the node, namely the minimal value
+ * over the rational points in the parent, rounded up.
+ */
+struct isl_ilp_bb_node {
+	int parent;
+	int pos;
+	int upper;
+	isl_int bound;
+	isl_int lower;
+};
+
+/* The branch-and-bound tree of solve_ilp_bb.
+ * "node" contains the "n" nodes that have been created so far
+ * and has room for "size" nodes.
+ * "open" contains the positions of the "n_open" nodes that
+ * have not been considered yet.
+ */
+struct isl_ilp_bb {
+	isl_ctx *ctx;
+
+	int n;
+	int size;
+	struct isl_ilp_bb_node *node;
+
+	int n_open;
+	int *open;
+};
+
+static void isl_ilp_bb_clear(struct isl_ilp_bb *bb)
+{
+	int i;
+
+	for (i = 0; i < bb->n; ++i) {
+		isl_int_clear(bb->node[i].bound);
+		isl_int_clear(bb->node[i].lower);
+	}
+	free(bb->node);
+	free(bb->open);
+}
+
+/* Add a node to "bb" with the given properties and mark it open.
+ */
+static int isl_ilp_bb_add(struct isl_ilp_bb *bb, int parent, int pos,
+	int upper, isl_int bound, isl_int lower)
+{
+	struct isl_ilp_bb_node *node;
+
+	if (bb->n >= bb->size) {
+		int size = 3 * bb->size / 2 + 8;
+		struct isl_ilp_bb_node *nodes;
+		int *open;
+
+		nodes = isl_realloc_array(bb->ctx, bb->node,
+					struct isl_ilp_bb_node, size);
+		if (!nodes)
+			return -1;
+		bb->node = nodes;
+		open = isl_realloc_array(bb->ctx, bb->open, int, size);
+		if (!open)
+			return -1;
+		bb->open = open;
+		bb->size = size;
+	}
+
+	node = &bb->node[bb->n];
+	node->parent = parent;
+	node->pos = pos;
+	node->upper = upper;
+	isl_int_init(node->bound);
+	isl_int_init(node->lower);
+	isl_int_set(node->bound, bound);
+	isl_int_set(node->lower, lower);
+	bb->open[bb->n_open++] = bb->n++;
+
+	return 0;
+}
+
+/* Remove the open node with the smallest lower bound from "bb"
+ * and return its position.
+ * In case of ties, the most recently created node is selected,
+ * such that the search dives into the tree until
+ * a better solution is found.
+ */
+static int isl_ilp_bb_select(struct isl_ilp_bb *bb)
+{
+	int i, best;
+	int node;
+
+	best = 0;
+	for (i = 1; i < bb->n_open; ++i) {
+		isl_int *lower = &bb->node[bb->open[i]].lower;
+		isl_int *best_lower = &bb->node[bb->open[best]].lower;
+
+		if (isl_int_lt(*lower, *best_lower) ||
+		    (isl_int_eq(*lower, *best_lower) &&
+		     bb->open[i] > bb->open[best]))
+			best = i;
+	}
+
+	node = bb->open[best];
+	bb->open[best] = bb->open[--bb->n_open];
+
+	return node;
+}
+
+/* Reset "tab" to the state "snap" of the root node and
+ * add the constraints of node "node" of "bb" and its ancestors.
+ * "ineq" is a vector of the appropriate size that can be used
+ * to construct the constraints.
+ */
+static int isl_ilp_bb_restore(struct isl_ilp_bb *bb, int node,
+	struct isl_tab *tab, struct isl_tab_undo *snap,
+	__isl_keep isl_vec *ineq)
+{
+	int i;
+	int depth;
+
+	if (isl_tab_rollback(tab, snap) < 0)
+		return -1;
+
+	depth = 0;
+	for (i = node; i >= 0; i = bb->node[i].parent)
+		++depth;
+	if (isl_tab_extend_cons(tab, depth) < 0)
+		return -1;
+
+	for (i = node; i >= 0 && !tab->empty; i = bb->node[i].parent) {
+		struct isl_ilp_bb_node *n = &bb->node[i];
+
+		if (n->parent < 0)
+			break;
+		isl_seq_clr(ineq->el, ineq->size);
+		if (n->upper) {
+			isl_int_set(ineq->el[0], n->bound);
+			isl_int_set_si(ineq->el[1 + n->pos], -1);
+		} else {
+			isl_int_neg(ineq->el[0], n->bound);
+			isl_int_set_si(ineq->el[1 + n->pos], 1);
+		}
+		if (isl_tab_add_ineq(tab, ineq->el) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/* Return the position of the first non-integral coordinate
+ * of the (rational) point "sample" or -1 if it is an integer point.
+ */
+static int first_non_integer(__isl_keep isl_vec *sample)
+{
+	int i;
+
+	if (isl_int_is_one(sample->el[0]))
+		return -1;
+	for (i = 1; i < sample->size; ++i)
+		if (!isl_int_is_divisible_by(sample->el[i], sample->el[0]))
+			return i - 1;
+	return -1;
+}
+
+/* Find an integer point in the bounded basic set "bset"
+ * that minimizes f (if any) using branch-and-bound.
+ * If sol_p is not NULL then the integer point is returned in *sol_p.
+ * The optimal value of f is returned in *opt.
+ *
+ * Each node of the search tree is a subset of "bset" obtained
+ * by imposing upper or lower bounds on some of the variables.
+ * The tableau of "bset" is reset to its original state and
+ * the constraints of a node are reimposed whenever a node
+ * is considered.
+ * In each node, the minimal value of f over the rational points
+ * is computed.  If it is attained at an integer point, then
+ * this integer point replaces the best solution found so far.
+ * Otherwise, two child nodes are created for the first non-integral
+ * coordinate, one with this coordinate bounded by the floor
+ * of its value and one with it bounded by the ceiling.
+ * The open node with the smallest lower bound is considered next.
+ * A node is discarded if its lower bound is not smaller than
+ * the value of the best solution found so far.
+ * Since f is an integer affine expression, the rational minimum
+ * of a node can be rounded up to obtain a lower bound
+ * on the values of f over its integer points.
+ * Since "bset" is bounded, each variable can only be split
+ * a finite number of times and the search terminates.
+ * However, the number of nodes may be very large for problems
+ * where many rational optima are close to the integer optimum.
+ * If ISL_ILP_BB_MAX_NODES nodes have been created, then
+ * the search is continued by solve_ilp_search on the interval
+ * between the smallest lower bound of the open nodes and
+ * the value of the best solution found so far, or by solve_ilp
+ * if no solution has been found yet.
+ */
+static enum isl_lp_result solve_ilp_bb(struct isl_basic_set *bset,
+				      isl_int *f, isl_int *opt,
+				      struct isl_vec **sol_p)
+{
+	isl_ctx *ctx;
+	enum isl_lp_result res;
+	struct isl_ilp_bb bb = { NULL };
+	struct isl_tab *tab;
+	struct isl_tab_undo *snap;
+	struct isl_vec *ineq;
+	struct isl_vec *sol = NULL;
+	unsigned dim;
+	int truncated;
+	isl_int lower;
+
+	ctx = isl_basic_set_get_ctx(bset);
+	dim = isl_basic_set_total_dim(bset);
+	bb.ctx = ctx;
+
+	isl_int_init(lower);
+	tab = isl_tab_from_basic_set(bset, 0);
+	snap = isl_tab_snap(tab);
+	ineq = isl_vec_alloc(ctx, 1 + dim);
+	if (!tab || !ineq)
+		goto error;
+	if (isl_ilp_bb_add(&bb, -1, 0, 0, lower, lower) < 0)
+		goto error;
+
+	while (bb.n_open > 0 && bb.n < ISL_ILP_BB_MAX_NODES) {
+		int node, pos;
+		struct isl_vec *sample;
+
+		node = isl_ilp_bb_select(&bb);
+		if (sol && isl_int_ge(bb.node[node].lower, *opt))
+			break;
+		if (isl_ilp_bb_restore(&bb, node, tab, snap, ineq) < 0)
+			goto error;
+		res = isl_tab_min(tab, f, ctx->one, &lower, NULL, 0);
+		if (res == isl_lp_error)
+			goto error;
+		if (res == isl_lp_unbounded)
+			isl_die(ctx, isl_error_internal,
+				"unexpected unbounded problem", goto error);
+		if (res == isl_lp_empty)
+			continue;
+		if (sol && isl_int_ge(lower, *opt))
+			continue;
+		sample = isl_tab_get_sample_value(tab);
+		if (!sample)
+			goto error;
+		pos = first_non_integer(sample);
+		if (pos < 0) {
+			isl_vec_free(sol);
+			sol = sample;
+			isl_int_set(*opt, lower);
+			continue;
+		}
+		isl_int_fdiv_q(ineq->el[0], sample->el[1 + pos], sample->el[0]);
+		isl_vec_free(sample);
+		if (isl_ilp_bb_add(&bb, node, pos, 1, ineq->el[0], lower) < 0)
+			goto error;
+		isl_int_add_ui(ineq->el[0], ineq->el[0], 1);
+		if (isl_ilp_bb_add(&bb, node, pos, 0, ineq->el[0], lower) < 0)
+			goto error;
+	}
+
+	truncated = bb.n_open > 0 && bb.n >= ISL_ILP_BB_MAX_NODES;
+	if (truncated && sol) {
+		isl_int u;
+
+		isl_int_set(lower, bb.node[isl_ilp_bb_select(&bb)].lower);
+		isl_int_init(u);
+		isl_int_sub_ui(u, *opt, 1);
+		sol = solve_ilp_search(bset, f, opt, sol, lower, u);
+		isl_int_clear(u);
+		if (!sol)
+			goto error;
+	}
+
+	isl_ilp_bb_clear(&bb);
+	isl_vec_free(ineq);
+	isl_tab_free(tab);
+	isl_int_clear(lower);
+
+	if (truncated && !sol)
+		return solve_ilp(bset, f, opt, sol_p);
+
+	res = sol ? isl_lp_ok : isl_lp_empty;
+	if (sol_p)
+		*sol_p = sol;
+	else
+		isl_vec_free(sol);
+
+	return res;
+error:
+	isl_ilp_bb_clear(&bb);
+	isl_vec_free(ineq);
+	isl_tab_free(tab);
+	isl_int_clear(lower);
+	isl_vec_free(sol);
+	return isl_lp_error;
+}
+
+/* Find an integer point in "bset" that minimizes f (if any)
+ * using the algorithm selected by the ilp-solver option.
+ * If sol_p is not NULL then the integer point is returned in *sol_p.
+ * The optimal value of f is returned in *opt.
+ *
+ * The branch-and-bound algorithm is only used if "bset" is bounded
+ * since it may not terminate on unbounded sets.
+ */
+static enum isl_lp_result solve_ilp_select(struct isl_basic_set *bset,
+				      isl_int *f, isl_int *opt,
+				      struct isl_vec **sol_p)
+{
+	int bounded;
+
+	if (bset->ctx->opt->ilp_solver != ISL_ILP_BB)
+		return solve_ilp(bset, f, opt, sol_p);
+
+	bounded = isl_basic_set_is_bounded(bset);
+	if (bounded < 0)
+		return isl_lp_error;
+	if (!bounded)
+		return solve_ilp(bset, f, opt, sol_p);
+	return solve_ilp_bb(bset, f, opt, sol_p);
+}
+
 static enum isl_lp_result solve_ilp_with_eq(struct isl_basic_set *bset, int max,
 				      isl_int *f, isl_int *opt,
 				      struct isl_vec **sol_p)
@@ -300,7 +630,7 @@ error:
  * The optimal value of f is returned in *opt.
  *
  * If there is any equality among the points in "bset", then we first
- * project it out.  Otherwise, we continue with solve_ilp above.
+ * project it out.  Otherwise, we continue with solve_ilp_select above.
  */
 enum isl_lp_result isl_basic_set_solve_ilp(struct isl_basic_set *bset, int max,
 				      isl_int *f, isl_int *opt,
@@ -327,7 +657,7 @@ enum isl_lp_result isl_basic_set_solve_ilp(struct isl_basic_set *bset, int max,
 	if (max)
 		isl_seq_neg(f, f, 1 + dim);
 
-	res = solve_ilp(bset, f, opt, sol_p);
+	res = solve_ilp_select(bset, f, opt, sol_p);
 
 	if (max) {
 		isl_seq_neg(f, f, 1 + dim);
@@ -3,15 +3,17 @@
 
 #include <isl_int.h>
 
-extern int isl_sioimath_decode(isl_sioimath val, int32_t *small, mp_int *big);
+extern int isl_sioimath_decode(isl_sioimath val, isl_sioimath_small_t *small,
+	mp_int *big);
 extern int isl_sioimath_decode_big(isl_sioimath val, mp_int *big);
-extern int isl_sioimath_decode_small(isl_sioimath val, int32_t *small);
+extern int isl_sioimath_decode_small(isl_sioimath val,
+	isl_sioimath_small_t *small);
 
-extern isl_sioimath isl_sioimath_encode_small(int32_t val);
+extern isl_sioimath isl_sioimath_encode_small(isl_sioimath_small_t val);
 extern isl_sioimath isl_sioimath_encode_big(mp_int val);
 extern int isl_sioimath_is_small(isl_sioimath val);
 extern int isl_sioimath_is_big(isl_sioimath val);
-extern int32_t isl_sioimath_get_small(isl_sioimath val);
+extern isl_sioimath_small_t isl_sioimath_get_small(isl_sioimath val);
 extern mp_int isl_sioimath_get_big(isl_sioimath val);
 
 extern void isl_siomath_uint32_to_digits(uint32_t num, mp_digit *digits,
@@ -30,7 +32,8 @@ extern mp_int isl_sioimath_si64arg_src(int64_t arg,
 extern mp_int isl_sioimath_uiarg_src(unsigned long arg,
 	isl_sioimath_scratchspace_t *scratch);
 extern mp_int isl_sioimath_reinit_big(isl_sioimath_ptr ptr);
-extern void isl_sioimath_set_small(isl_sioimath_ptr ptr, int32_t val);
+extern void isl_sioimath_set_small(isl_sioimath_ptr ptr,
+	isl_sioimath_small_t val);
 extern void isl_sioimath_set_int32(isl_sioimath_ptr ptr, int32_t val);
 extern void isl_sioimath_set_int64(isl_sioimath_ptr ptr, int64_t val);
 extern void isl_sioimath_promote(isl_sioimath_ptr dst);
@@ -59,6 +62,21 @@ extern void isl_sioimath_add(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs);
 extern void isl_sioimath_sub(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs);
+extern int isl_sioimath_small_mul(int64_t *product, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs);
+extern int isl_sioimath_small_mul_si(int64_t *product,
+	isl_sioimath_small_t lhs, signed long rhs);
+extern int isl_sioimath_small_mul_ui(int64_t *product,
+	isl_sioimath_small_t lhs, unsigned long rhs);
+extern int isl_sioimath_small_addmul(int64_t *result,
+	isl_sioimath_small_t acc, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs);
+extern int isl_sioimath_small_submul(int64_t *result,
+	isl_sioimath_small_t acc, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs);
+extern int isl_sioimath_small_combine(int64_t *result,
+	isl_sioimath_small_t m1, isl_sioimath_small_t a,
+	isl_sioimath_small_t m2, isl_sioimath_small_t b);
 extern void isl_sioimath_mul(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs);
 extern void isl_sioimath_mul_2exp(isl_sioimath_ptr dst, isl_sioimath lhs,
@@ -81,12 +99,13 @@ extern void isl_sioimath_submul_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 /* Implements the Euclidean algorithm to compute the greatest common divisor of
  * two values in small representation.
  */
-static uint32_t isl_sioimath_smallgcd(int32_t lhs, int32_t rhs)
+isl_sioimath_usmall_t isl_sioimath_smallgcd(isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
 {
-	uint32_t dividend, divisor, remainder;
+	isl_sioimath_usmall_t dividend, divisor, remainder;
 
-	dividend = labs(lhs);
-	divisor = labs(rhs);
+	dividend = lhs < 0 ? -lhs : lhs;
+	divisor = rhs < 0 ? -rhs : rhs;
 	while (divisor) {
 		remainder = dividend % divisor;
 		dividend = divisor;
@@ -103,8 +122,8 @@ static uint32_t isl_sioimath_smallgcd(int32_t lhs, int32_t rhs)
 inline void isl_sioimath_gcd(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
-	int32_t lhssmall, rhssmall;
-	uint32_t smallgcd;
+	isl_sioimath_small_t lhssmall, rhssmall;
+	isl_sioimath_usmall_t smallgcd;
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
@@ -121,13 +140,17 @@ inline void isl_sioimath_gcd(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 }
 
 /* Compute the lowest common multiple of two numbers.
+ *
+ * If both numbers are in small representation, then the result
+ * is computed as |lhs| / gcd * |rhs|, falling back to IMath
+ * only if this product does not fit in an int64_t.
  */
 void isl_sioimath_lcm(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
-	int32_t lhssmall, rhssmall;
-	uint32_t smallgcd;
-	uint64_t multiple;
+	isl_sioimath_small_t lhssmall, rhssmall;
+	isl_sioimath_usmall_t smallgcd;
+	int64_t multiple;
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
@@ -137,9 +160,13 @@ void isl_sioimath_lcm(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 			return;
 		}
 		smallgcd = isl_sioimath_smallgcd(lhssmall, rhssmall);
-		multiple = (uint64_t) abs(lhssmall) * (uint64_t) abs(rhssmall);
-		isl_sioimath_set_int64(dst, multiple / smallgcd);
-		return;
+		lhssmall = lhssmall < 0 ? -lhssmall : lhssmall;
+		rhssmall = rhssmall < 0 ? -rhssmall : rhssmall;
+		if (isl_sioimath_small_mul(&multiple,
+		    lhssmall / (isl_sioimath_small_t) smallgcd, rhssmall)) {
+			isl_sioimath_set_int64(dst, multiple);
+			return;
+		}
 	}
 
 	impz_lcm(isl_sioimath_reinit_big(dst),
@@ -162,14 +189,14 @@ extern void isl_sioimath_fdiv_r(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs);
 
 /* Parse a number from a string.
- * If it has less than 10 characters then it will fit into the small
- * representation (i.e. strlen("2147483647")). Otherwise, let IMath parse it.
+ * If it has less than ISL_SIOIMATH_SMALL_STRLEN characters then it will fit
+ * into the small representation. Otherwise, let IMath parse it.
  */
 void isl_sioimath_read(isl_sioimath_ptr dst, const char *str)
 {
-	int32_t small;
+	isl_sioimath_small_t small;
 
-	if (strlen(str) < 10) {
+	if (strlen(str) < ISL_SIOIMATH_SMALL_STRLEN) {
 		small = strtol(str, NULL, 10);
 		isl_sioimath_set_small(dst, small);
 		return;
@@ -196,12 +223,12 @@ extern void isl_sioimath_print(FILE *out, isl_sioimath_src i, int width);
 void isl_sioimath_print(FILE *out, isl_sioimath_src i, int width)
 {
 	size_t len;
-	int32_t small;
+	isl_sioimath_small_t small;
 	mp_int big;
 	char *buf;
 
 	if (isl_sioimath_decode_small(i, &small)) {
-		fprintf(out, "%*" PRIi32, width, small);
+		fprintf(out, "%*" PRIi64, width, (int64_t) small);
 		return;
 	}
 
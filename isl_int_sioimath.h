@@ -47,15 +47,28 @@
  * On 32 bit machines isl_sioimath type is blown up to 8 bytes, i.e.
  * isl_sioimath is guaranteed to be at least 8 bytes. This is to ensure the
  * int32_t can be hidden in that type without data loss. In the future we might
- * optimize this to use 31 hidden bits in a 32 bit pointer. We may also use 63
- * bits on 64 bit machines, but this comes with the cost of additional overflow
- * checks because there is no standardized 128 bit integer we could expand to.
+ * optimize this to use 31 hidden bits in a 32 bit pointer.
+ *
+ * If USE_SMALL_INT64_OPT is defined (--with-int=imath-64), then the small
+ * representation instead uses all 63 bits above the discriminator bit
+ * to store an int64_t:
+ *
+ * Small representation (USE_SMALL_INT64_OPT):
+ * MSB                                                          LSB
+ * |--------------------------------------------------------------1
+ * |                          int64_t                           |
+ * |        4611686018427387903 ... -4611686018427387903        |
+ *
+ * The range is restricted to 62 bits plus sign such that the sum or
+ * difference of two small values always fits in an int64_t.
+ * Products are computed using the compiler's overflow checking builtins
+ * and fall back to IMath if they overflow.
  *
  * We use native integer types and avoid union structures to avoid assumptions
  * on the machine's endianness.
  *
  * This implementation makes the following assumptions:
- * - long can represent any int32_t
+ * - long can represent any isl_sioimath_small_t
  * - mp_small is signed long
  * - mp_usmall is unsigned long
  * - adresses returned by malloc are aligned to 2-byte boundaries (leastmost
@@ -67,6 +80,36 @@ typedef uint64_t isl_sioimath;
 typedef uintptr_t isl_sioimath;
 #endif
 
+#ifdef USE_SMALL_INT64_OPT
+/* The type of a number in small representation and its unsigned counterpart.
+ */
+typedef int64_t isl_sioimath_small_t;
+typedef uint64_t isl_sioimath_usmall_t;
+
+/* The small representation is restricted to the symmetric range
+ * [-(2^62-1), 2^62-1] such that additions, subtractions and negations
+ * of small values never overflow an int64_t.
+ */
+#define ISL_SIOIMATH_SMALL_MIN (-ISL_SIOIMATH_SMALL_MAX)
+
+/* Largest possible number in small representation */
+#define ISL_SIOIMATH_SMALL_MAX INT64_C(0x3FFFFFFFFFFFFFFF)
+
+/* Number of bits required to represent the absolute value
+ * of any number in small representation.
+ */
+#define ISL_SIOIMATH_SMALL_BITS 62
+
+/* Any decimal string with fewer characters than this (including the sign)
+ * represents a number in the small range.
+ */
+#define ISL_SIOIMATH_SMALL_STRLEN 19
+#else
+/* The type of a number in small representation and its unsigned counterpart.
+ */
+typedef int32_t isl_sioimath_small_t;
+typedef uint32_t isl_sioimath_usmall_t;
+
 /* The negation of the smallest possible number in int32_t, INT32_MIN
  * (0x80000000u, -2147483648), cannot be represented in an int32_t, therefore
  * every operation that may produce this value needs to special-case it.
@@ -83,6 +126,17 @@ typedef uintptr_t isl_sioimath;
 /* Largest possible number in small representation */
 #define ISL_SIOIMATH_SMALL_MAX INT32_MAX
 
+/* Number of bits required to represent the absolute value
+ * of any number in small representation.
+ */
+#define ISL_SIOIMATH_SMALL_BITS 31
+
+/* Any decimal string with fewer characters than this (including the sign)
+ * represents a number in the small range (i.e., strlen("2147483647")).
+ */
+#define ISL_SIOIMATH_SMALL_STRLEN 10
+#endif
+
 /* Used for function parameters the function modifies. */
 typedef isl_sioimath *isl_sioimath_ptr;
 
@@ -103,13 +157,25 @@ inline int isl_sioimath_is_big(isl_sioimath val)
 	return !isl_sioimath_is_small(val);
 }
 
+#ifdef USE_SMALL_INT64_OPT
 /* Get the number of an isl_int in small representation. Result is undefined if
  * val is not stored in that format.
+ *
+ * The arithmetic shift of the signed value restores the sign bits.
  */
-inline int32_t isl_sioimath_get_small(isl_sioimath val)
+inline isl_sioimath_small_t isl_sioimath_get_small(isl_sioimath val)
+{
+	return ((int64_t) val) >> 1;
+}
+#else
+/* Get the number of an isl_int in small representation. Result is undefined if
+ * val is not stored in that format.
+ */
+inline isl_sioimath_small_t isl_sioimath_get_small(isl_sioimath val)
 {
 	return val >> 32;
 }
+#endif
 
 /* Get the number of an in isl_int in big representation. Result is undefined if
  * val is not stored in that format.
@@ -125,7 +191,8 @@ inline mp_int isl_sioimath_get_big(isl_sioimath val)
  * representation. If there is no such branch, then a single shift is still
  * cheaper than introducing branching code.
  */
-inline int isl_sioimath_decode_small(isl_sioimath val, int32_t *small)
+inline int isl_sioimath_decode_small(isl_sioimath val,
+	isl_sioimath_small_t *small)
 {
 	*small = isl_sioimath_get_small(val);
 	return isl_sioimath_is_small(val);
@@ -139,12 +206,21 @@ inline int isl_sioimath_decode_big(isl_sioimath val, mp_int *big)
 	return isl_sioimath_is_big(val);
 }
 
+#ifdef USE_SMALL_INT64_OPT
+/* Encode a small representation into an isl_int.
+ */
+inline isl_sioimath isl_sioimath_encode_small(isl_sioimath_small_t val)
+{
+	return ((isl_sioimath) val) << 1 | 0x00000001;
+}
+#else
 /* Encode a small representation into an isl_int.
  */
-inline isl_sioimath isl_sioimath_encode_small(int32_t val)
+inline isl_sioimath isl_sioimath_encode_small(isl_sioimath_small_t val)
 {
 	return ((isl_sioimath) val) << 32 | 0x00000001;
 }
+#endif
 
 /* Encode a big representation.
  */
@@ -240,8 +316,8 @@ inline mp_int isl_sioimath_bigarg_src(isl_sioimath arg,
 	isl_sioimath_scratchspace_t *scratch)
 {
 	mp_int big;
-	int32_t small;
-	uint32_t num;
+	isl_sioimath_small_t small;
+	isl_sioimath_usmall_t num;
 
 	if (isl_sioimath_decode_big(arg, &big))
 		return big;
@@ -257,7 +333,7 @@ inline mp_int isl_sioimath_bigarg_src(isl_sioimath arg,
 		num = -small;
 	}
 
-	isl_siomath_uint32_to_digits(num, scratch->digits, &scratch->big.used);
+	ISL_SIOIMATH_TO_DIGITS(num, scratch->digits, scratch->big.used);
 	return &scratch->big;
 }
 
@@ -329,7 +405,8 @@ inline mp_int isl_sioimath_reinit_big(isl_sioimath_ptr ptr)
 
 /* Set ptr to a number in small representation.
  */
-inline void isl_sioimath_set_small(isl_sioimath_ptr ptr, int32_t val)
+inline void isl_sioimath_set_small(isl_sioimath_ptr ptr,
+	isl_sioimath_small_t val)
 {
 	if (isl_sioimath_is_big(*ptr))
 		mp_int_free(isl_sioimath_get_big(*ptr));
@@ -366,7 +443,7 @@ inline void isl_sioimath_set_int64(isl_sioimath_ptr ptr, int64_t val)
  */
 inline void isl_sioimath_promote(isl_sioimath_ptr dst)
 {
-	int32_t small;
+	isl_sioimath_small_t small;
 
 	if (isl_sioimath_is_big(*dst))
 		return;
@@ -521,16 +598,17 @@ inline double isl_sioimath_get_d(isl_sioimath_src val)
 
 /* Format a number as decimal string.
  *
- * The largest possible string from small representation is 12 characters
- *("-2147483647").
+ * The largest possible string from small representation is 21 characters
+ * ("-4611686018427387903") including the terminating null character.
  */
 inline char *isl_sioimath_get_str(isl_sioimath_src val)
 {
 	char *result;
 
 	if (isl_sioimath_is_small(val)) {
-		result = malloc(12);
-		snprintf(result, 12, "%" PRIi32, isl_sioimath_get_small(val));
+		result = malloc(21);
+		snprintf(result, 21, "%" PRIi64,
+		    (int64_t) isl_sioimath_get_small(val));
 		return result;
 	}
 
@@ -541,8 +619,10 @@ inline char *isl_sioimath_get_str(isl_sioimath_src val)
  */
 inline void isl_sioimath_abs(isl_sioimath_ptr dst, isl_sioimath_src arg)
 {
-	if (isl_sioimath_is_small(arg)) {
-		isl_sioimath_set_small(dst, labs(isl_sioimath_get_small(arg)));
+	isl_sioimath_small_t small;
+
+	if (isl_sioimath_decode_small(arg, &small)) {
+		isl_sioimath_set_small(dst, small < 0 ? -small : small);
 		return;
 	}
 
@@ -581,7 +661,7 @@ inline void isl_sioimath_swap(isl_sioimath_ptr lhs, isl_sioimath_ptr rhs)
 inline void isl_sioimath_add_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 	unsigned long rhs)
 {
-	int32_t smalllhs;
+	isl_sioimath_small_t smalllhs;
 	isl_sioimath_scratchspace_t lhsscratch;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
@@ -604,11 +684,11 @@ inline void isl_sioimath_add_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 inline void isl_sioimath_sub_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 				unsigned long rhs)
 {
-	int32_t smalllhs;
+	isl_sioimath_small_t smalllhs;
 	isl_sioimath_scratchspace_t lhsscratch;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
-	    (rhs < (uint64_t) INT64_MIN - (uint64_t) ISL_SIOIMATH_SMALL_MIN)) {
+	    (rhs <= (uint64_t) INT64_MAX - (uint64_t) ISL_SIOIMATH_SMALL_MAX)) {
 		isl_sioimath_set_int64(dst, (int64_t) smalllhs - rhs);
 		return;
 	}
@@ -624,7 +704,7 @@ inline void isl_sioimath_add(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs, smallrhs;
+	isl_sioimath_small_t smalllhs, smallrhs;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
 	    isl_sioimath_decode_small(rhs, &smallrhs)) {
@@ -645,7 +725,7 @@ inline void isl_sioimath_sub(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs, smallrhs;
+	isl_sioimath_small_t smalllhs, smallrhs;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
 	    isl_sioimath_decode_small(rhs, &smallrhs)) {
@@ -660,18 +740,172 @@ inline void isl_sioimath_sub(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_try_demote(dst);
 }
 
+#ifdef USE_SMALL_INT64_OPT
+/* Compute the product of two numbers in small representation and store
+ * it in "product".  Return 0 if the product does not fit in an int64_t,
+ * in which case "product" is left in an undefined state.
+ */
+inline int isl_sioimath_small_mul(int64_t *product, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
+{
+	return !__builtin_mul_overflow(lhs, rhs, product);
+}
+
+/* Compute the product of a number in small representation and
+ * a signed long and store it in "product".
+ * Return 0 if the product does not fit in an int64_t.
+ */
+inline int isl_sioimath_small_mul_si(int64_t *product,
+	isl_sioimath_small_t lhs, signed long rhs)
+{
+	return !__builtin_mul_overflow(lhs, rhs, product);
+}
+
+/* Compute the product of a number in small representation and
+ * an unsigned long and store it in "product".
+ * Return 0 if the product does not fit in an int64_t.
+ */
+inline int isl_sioimath_small_mul_ui(int64_t *product,
+	isl_sioimath_small_t lhs, unsigned long rhs)
+{
+	return !__builtin_mul_overflow(lhs, rhs, product);
+}
+
+/* Compute "acc + lhs * rhs" for numbers in small representation and
+ * store it in "result".  Return 0 if any intermediate result
+ * does not fit in an int64_t.
+ */
+inline int isl_sioimath_small_addmul(int64_t *result,
+	isl_sioimath_small_t acc, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
+{
+	int64_t product;
+
+	if (__builtin_mul_overflow(lhs, rhs, &product))
+		return 0;
+	return !__builtin_add_overflow(acc, product, result);
+}
+
+/* Compute "acc - lhs * rhs" for numbers in small representation and
+ * store it in "result".  Return 0 if any intermediate result
+ * does not fit in an int64_t.
+ */
+inline int isl_sioimath_small_submul(int64_t *result,
+	isl_sioimath_small_t acc, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
+{
+	int64_t product;
+
+	if (__builtin_mul_overflow(lhs, rhs, &product))
+		return 0;
+	return !__builtin_sub_overflow(acc, product, result);
+}
+
+/* Compute "m1 * a + m2 * b" for numbers in small representation and
+ * store it in "result".  Return 0 if any intermediate result
+ * does not fit in an int64_t.
+ */
+inline int isl_sioimath_small_combine(int64_t *result,
+	isl_sioimath_small_t m1, isl_sioimath_small_t a,
+	isl_sioimath_small_t m2, isl_sioimath_small_t b)
+{
+	int64_t p1, p2;
+
+	if (__builtin_mul_overflow(m1, a, &p1))
+		return 0;
+	if (__builtin_mul_overflow(m2, b, &p2))
+		return 0;
+	return !__builtin_add_overflow(p1, p2, result);
+}
+#else
+/* Compute the product of two numbers in small representation and store
+ * it in "product".  The product of two int32_t always fits in an int64_t.
+ */
+inline int isl_sioimath_small_mul(int64_t *product, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
+{
+	*product = (int64_t) lhs * (int64_t) rhs;
+	return 1;
+}
+
+/* Compute the product of a number in small representation and
+ * a signed long and store it in "product".
+ * Return 0 if the absolute value of "rhs" exceeds 32 bits, in which case
+ * the product may not fit in an int64_t.
+ */
+inline int isl_sioimath_small_mul_si(int64_t *product,
+	isl_sioimath_small_t lhs, signed long rhs)
+{
+	if (rhs == LONG_MIN || labs(rhs) > UINT32_MAX)
+		return 0;
+	*product = (int64_t) lhs * (int64_t) rhs;
+	return 1;
+}
+
+/* Compute the product of a number in small representation and
+ * an unsigned long and store it in "product".
+ * Return 0 if "rhs" exceeds 32 bits, in which case the product
+ * may not fit in an int64_t.
+ */
+inline int isl_sioimath_small_mul_ui(int64_t *product,
+	isl_sioimath_small_t lhs, unsigned long rhs)
+{
+	if (rhs > UINT32_MAX)
+		return 0;
+	*product = (int64_t) lhs * (int64_t) rhs;
+	return 1;
+}
+
+/* Compute "acc + lhs * rhs" for numbers in small representation and
+ * store it in "result".  The product is at most 62 bits in absolute value,
+ * so the result always fits in an int64_t.
+ */
+inline int isl_sioimath_small_addmul(int64_t *result,
+	isl_sioimath_small_t acc, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
+{
+	*result = (int64_t) acc + (int64_t) lhs * (int64_t) rhs;
+	return 1;
+}
+
+/* Compute "acc - lhs * rhs" for numbers in small representation and
+ * store it in "result".  The product is at most 62 bits in absolute value,
+ * so the result always fits in an int64_t.
+ */
+inline int isl_sioimath_small_submul(int64_t *result,
+	isl_sioimath_small_t acc, isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs)
+{
+	*result = (int64_t) acc - (int64_t) lhs * (int64_t) rhs;
+	return 1;
+}
+
+/* Compute "m1 * a + m2 * b" for numbers in small representation and
+ * store it in "result".  Each product is at most 62 bits in absolute value,
+ * so the result always fits in an int64_t.
+ */
+inline int isl_sioimath_small_combine(int64_t *result,
+	isl_sioimath_small_t m1, isl_sioimath_small_t a,
+	isl_sioimath_small_t m2, isl_sioimath_small_t b)
+{
+	*result = (int64_t) m1 * (int64_t) a + (int64_t) m2 * (int64_t) b;
+	return 1;
+}
+#endif
+
 /* Multiply two isl_ints.
  */
 inline void isl_sioimath_mul(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs, smallrhs;
+	isl_sioimath_small_t smalllhs, smallrhs;
+	int64_t product;
 
 	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
-	    isl_sioimath_decode_small(rhs, &smallrhs)) {
-		isl_sioimath_set_int64(
-		    dst, (int64_t) smalllhs * (int64_t) smallrhs);
+	    isl_sioimath_decode_small(rhs, &smallrhs) &&
+	    isl_sioimath_small_mul(&product, smalllhs, smallrhs)) {
+		isl_sioimath_set_int64(dst, product);
 		return;
 	}
 
@@ -688,9 +922,10 @@ inline void isl_sioimath_mul_2exp(isl_sioimath_ptr dst, isl_sioimath lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs;
-	int32_t smalllhs;
+	isl_sioimath_small_t smalllhs;
 
-	if (isl_sioimath_decode_small(lhs, &smalllhs) && (rhs <= 32ul)) {
+	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    (rhs <= 63ul - ISL_SIOIMATH_SMALL_BITS)) {
 		isl_sioimath_set_int64(dst, ((int64_t) smalllhs) << rhs);
 		return;
 	}
@@ -705,11 +940,12 @@ inline void isl_sioimath_mul_si(isl_sioimath_ptr dst, isl_sioimath lhs,
 	signed long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs;
+	isl_sioimath_small_t smalllhs;
+	int64_t product;
 
-	if (isl_sioimath_decode_small(lhs, &smalllhs) && (rhs > LONG_MIN) &&
-	    (labs(rhs) <= UINT32_MAX)) {
-		isl_sioimath_set_int64(dst, (int64_t) smalllhs * (int64_t) rhs);
+	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    isl_sioimath_small_mul_si(&product, smalllhs, rhs)) {
+		isl_sioimath_set_int64(dst, product);
 		return;
 	}
 
@@ -725,10 +961,12 @@ inline void isl_sioimath_mul_ui(isl_sioimath_ptr dst, isl_sioimath lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs;
+	isl_sioimath_small_t smalllhs;
+	int64_t product;
 
-	if (isl_sioimath_decode_small(lhs, &smalllhs) && (rhs <= UINT32_MAX)) {
-		isl_sioimath_set_int64(dst, (int64_t) smalllhs * (int64_t) rhs);
+	if (isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    isl_sioimath_small_mul_ui(&product, smalllhs, rhs)) {
+		isl_sioimath_set_int64(dst, product);
 		return;
 	}
 
@@ -748,7 +986,7 @@ inline void isl_sioimath_pow_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t scratchlhs, scratchrhs;
-	int32_t smalllhs;
+	isl_sioimath_small_t smalllhs;
 
 	switch (rhs) {
 	case 0:
@@ -791,11 +1029,25 @@ inline void isl_sioimath_pow_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 }
 
 /* Fused multiply-add.
+ *
+ * If all arguments are in small representation, then the result
+ * is computed without any intermediate isl_int.
  */
 inline void isl_sioimath_addmul(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath tmp;
+	isl_sioimath_small_t smalldst, smalllhs, smallrhs;
+	int64_t result;
+
+	if (isl_sioimath_decode_small(*dst, &smalldst) &&
+	    isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    isl_sioimath_decode_small(rhs, &smallrhs) &&
+	    isl_sioimath_small_addmul(&result, smalldst, smalllhs, smallrhs)) {
+		isl_sioimath_set_int64(dst, result);
+		return;
+	}
+
 	isl_sioimath_init(&tmp);
 	isl_sioimath_mul(&tmp, lhs, rhs);
 	isl_sioimath_add(dst, *dst, tmp);
@@ -815,11 +1067,25 @@ inline void isl_sioimath_addmul_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 }
 
 /* Fused multiply-subtract.
+ *
+ * If all arguments are in small representation, then the result
+ * is computed without any intermediate isl_int.
  */
 inline void isl_sioimath_submul(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath tmp;
+	isl_sioimath_small_t smalldst, smalllhs, smallrhs;
+	int64_t result;
+
+	if (isl_sioimath_decode_small(*dst, &smalldst) &&
+	    isl_sioimath_decode_small(lhs, &smalllhs) &&
+	    isl_sioimath_decode_small(rhs, &smallrhs) &&
+	    isl_sioimath_small_submul(&result, smalldst, smalllhs, smallrhs)) {
+		isl_sioimath_set_int64(dst, result);
+		return;
+	}
+
 	isl_sioimath_init(&tmp);
 	isl_sioimath_mul(&tmp, lhs, rhs);
 	isl_sioimath_sub(dst, *dst, tmp);
@@ -838,6 +1104,8 @@ inline void isl_sioimath_submul_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_clear(&tmp);
 }
 
+isl_sioimath_usmall_t isl_sioimath_smallgcd(isl_sioimath_small_t lhs,
+	isl_sioimath_small_t rhs);
 void isl_sioimath_gcd(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 		      isl_sioimath_src rhs);
 void isl_sioimath_lcm(isl_sioimath_ptr dst, isl_sioimath_src lhs,
@@ -849,7 +1117,7 @@ inline void isl_sioimath_tdiv_q(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small_t lhssmall, rhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
@@ -870,11 +1138,13 @@ inline void isl_sioimath_tdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall;
+	isl_sioimath_small_t lhssmall;
 
-	if (isl_sioimath_is_small(lhs) && (rhs <= (unsigned long) INT32_MAX)) {
+	if (isl_sioimath_is_small(lhs) &&
+	    (rhs <= (unsigned long) ISL_SIOIMATH_SMALL_MAX)) {
 		lhssmall = isl_sioimath_get_small(lhs);
-		isl_sioimath_set_small(dst, lhssmall / (int32_t) rhs);
+		isl_sioimath_set_small(dst,
+		    lhssmall / (isl_sioimath_small_t) rhs);
 		return;
 	}
 
@@ -896,9 +1166,9 @@ inline void isl_sioimath_tdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 inline void isl_sioimath_cdiv_q(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small_t lhssmall, rhssmall;
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t q;
+	isl_sioimath_small_t q;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
@@ -926,8 +1196,8 @@ inline void isl_sioimath_fdiv_q(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
-	int32_t q;
+	isl_sioimath_small_t lhssmall, rhssmall;
+	isl_sioimath_small_t q;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
@@ -956,11 +1226,12 @@ inline void isl_sioimath_fdiv_q_ui(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 	unsigned long rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, q;
+	isl_sioimath_small_t lhssmall, q;
 
-	if (isl_sioimath_decode_small(lhs, &lhssmall) && (rhs <= INT32_MAX)) {
+	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
+	    (rhs <= (unsigned long) ISL_SIOIMATH_SMALL_MAX)) {
 		if (lhssmall >= 0)
-			q = (uint32_t) lhssmall / rhs;
+			q = (isl_sioimath_usmall_t) lhssmall / rhs;
 		else
 			q = ((int64_t) lhssmall - ((int64_t) rhs - 1)) /
 			    (int64_t) rhs;
@@ -982,7 +1253,7 @@ inline void isl_sioimath_fdiv_r(isl_sioimath_ptr dst, isl_sioimath_src lhs,
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
 	int64_t lhssmall, rhssmall;
-	int32_t r;
+	isl_sioimath_small_t r;
 
 	if (isl_sioimath_is_small(lhs) && isl_sioimath_is_small(rhs)) {
 		lhssmall = isl_sioimath_get_small(lhs);
@@ -1007,7 +1278,7 @@ void isl_sioimath_read(isl_sioimath_ptr dst, const char *str);
  */
 inline int isl_sioimath_sgn(isl_sioimath_src arg)
 {
-	int32_t small;
+	isl_sioimath_small_t small;
 
 	if (isl_sioimath_decode_small(arg, &small))
 		return (small > 0) - (small < 0);
@@ -1023,7 +1294,7 @@ inline int isl_sioimath_sgn(isl_sioimath_src arg)
 inline int isl_sioimath_cmp(isl_sioimath_src lhs, isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small_t lhssmall, rhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall))
@@ -1045,7 +1316,7 @@ inline int isl_sioimath_cmp(isl_sioimath_src lhs, isl_sioimath_src rhs)
  */
 inline int isl_sioimath_cmp_si(isl_sioimath_src lhs, signed long rhs)
 {
-	int32_t lhssmall;
+	isl_sioimath_small_t lhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall))
 		return (lhssmall > rhs) - (lhssmall < rhs);
@@ -1061,12 +1332,12 @@ inline int isl_sioimath_cmp_si(isl_sioimath_src lhs, signed long rhs)
 inline int isl_sioimath_abs_cmp(isl_sioimath_src lhs, isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small_t lhssmall, rhssmall;
 
 	if (isl_sioimath_decode_small(lhs, &lhssmall) &&
 	    isl_sioimath_decode_small(rhs, &rhssmall)) {
-		lhssmall = labs(lhssmall);
-		rhssmall = labs(rhssmall);
+		lhssmall = lhssmall < 0 ? -lhssmall : lhssmall;
+		rhssmall = rhssmall < 0 ? -rhssmall : rhssmall;
 		return (lhssmall > rhssmall) - (lhssmall < rhssmall);
 	}
 
@@ -1081,7 +1352,7 @@ inline int isl_sioimath_is_divisible_by(isl_sioimath_src lhs,
 					isl_sioimath_src rhs)
 {
 	isl_sioimath_scratchspace_t lhsscratch, rhsscratch;
-	int32_t lhssmall, rhssmall;
+	isl_sioimath_small_t lhssmall, rhssmall;
 	mpz_t rem;
 	int cmp;
 
@@ -1107,10 +1378,10 @@ inline int isl_sioimath_is_divisible_by(isl_sioimath_src lhs,
  */
 inline uint32_t isl_sioimath_hash(isl_sioimath_src arg, uint32_t hash)
 {
-	int32_t small;
+	isl_sioimath_small_t small;
 	int i;
-	uint32_t num;
-	mp_digit digits[(sizeof(uint32_t) + sizeof(mp_digit) - 1) /
+	isl_sioimath_usmall_t num;
+	mp_digit digits[(sizeof(isl_sioimath_usmall_t) + sizeof(mp_digit) - 1) /
 	                sizeof(mp_digit)];
 	mp_size used;
 	const unsigned char *digitdata = (const unsigned char *) &digits;
@@ -1118,9 +1389,9 @@ inline uint32_t isl_sioimath_hash(isl_sioimath_src arg, uint32_t hash)
 	if (isl_sioimath_decode_small(arg, &small)) {
 		if (small < 0)
 			isl_hash_byte(hash, 0xFF);
-		num = labs(small);
+		num = small < 0 ? -small : small;
 
-		isl_siomath_uint32_to_digits(num, digits, &used);
+		ISL_SIOIMATH_TO_DIGITS(num, digits, used);
 		for (i = 0; i < used * sizeof(mp_digit); i += 1)
 			isl_hash_byte(hash, digitdata[i]);
 		return hash;
@@ -1138,10 +1409,10 @@ inline uint32_t isl_sioimath_hash(isl_sioimath_src arg, uint32_t hash)
  */
 inline size_t isl_sioimath_sizeinbase(isl_sioimath_src arg, int base)
 {
-	int32_t small;
+	isl_sioimath_small_t small;
 
 	if (isl_sioimath_decode_small(arg, &small))
-		return sizeof(int32_t) * CHAR_BIT - 1;
+		return sizeof(isl_sioimath_small_t) * CHAR_BIT - 1;
 
 	return impz_sizeinbase(isl_sioimath_get_big(arg), base);
 }
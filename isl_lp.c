@@ -10,6 +10,7 @@
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
 #include <isl/lp.h>
+#include <isl_lp_private.h>
 #include <isl_seq.h>
 #include "isl_tab.h"
 #include <isl_options_private.h>
@@ -58,6 +59,8 @@ enum isl_lp_result isl_tab_solve_lp(struct isl_basic_map *bmap, int maximize,
  * to the nearest integer.
  * The return value reflects the nature of the result (empty, unbounded,
  * minmimal or maximal value returned in *opt).
+ *
+ * The problem is solved by the LP solver selected by the lp-solver option.
  */
 enum isl_lp_result isl_basic_map_solve_lp(struct isl_basic_map *bmap, int max,
 				      isl_int *f, isl_int d, isl_int *opt,
@@ -70,7 +73,14 @@ enum isl_lp_result isl_basic_map_solve_lp(struct isl_basic_map *bmap, int max,
 	if (!bmap)
 		return isl_lp_error;
 
-	return isl_tab_solve_lp(bmap, max, f, d, opt, opt_denom, sol);
+	switch (bmap->ctx->opt->lp_solver) {
+	case ISL_LP_FLOAT:
+		return isl_float_solve_lp(bmap, max, f, d, opt, opt_denom, sol);
+	case ISL_LP_TAB:
+		return isl_tab_solve_lp(bmap, max, f, d, opt, opt_denom, sol);
+	default:
+		return isl_lp_error;
+	}
 }
 
 enum isl_lp_result isl_basic_set_solve_lp(struct isl_basic_set *bset, int max,
@@ -0,0 +1,557 @@
+/*
+ * Use of this software is governed by the MIT license
+ */
+
+#include <isl_ctx_private.h>
+#include <isl_map_private.h>
+#include <isl_lp_private.h>
+#include <isl_seq.h>
+#include <isl_vec_private.h>
+#include "isl_tab.h"
+
+#define ISL_FLOAT_EPS	1e-9
+
+/* A dense simplex tableau over doubles for the problem
+ *
+ *	min c z	subject to A z = b, z >= 0
+ *
+ * with b >= 0.
+ *
+ * Row i of "a" (with 0 <= i < n_row) contains row i of A, followed by b_i.
+ * Row n_row contains the reduced costs, followed by minus the current
+ * value of the objective function.
+ * Each row has n_col + 1 elements.
+ * basis[i] is the column of the basic variable of row i.
+ * The columns starting at "art" correspond to artificial variables.
+ * They are only allowed to enter the basis during the first phase.
+ */
+struct isl_float_tab {
+	int n_row;
+	int n_col;
+	int art;
+	double *a;
+	int *basis;
+};
+
+static double *float_tab_row(struct isl_float_tab *tab, int row)
+{
+	return tab->a + row * (tab->n_col + 1);
+}
+
+static double float_abs(double v)
+{
+	return v < 0 ? -v : v;
+}
+
+static void float_tab_free(struct isl_float_tab *tab)
+{
+	if (!tab)
+		return;
+	free(tab->a);
+	free(tab->basis);
+	free(tab);
+}
+
+/* Pivot the basic variable of row "row" out of the basis
+ * and the variable of column "col" into the basis.
+ */
+static void float_tab_pivot(struct isl_float_tab *tab, int row, int col)
+{
+	int i, j;
+	double *p, *r;
+	double v;
+
+	p = float_tab_row(tab, row);
+	v = p[col];
+	for (j = 0; j <= tab->n_col; ++j)
+		p[j] /= v;
+	for (i = 0; i <= tab->n_row; ++i) {
+		if (i == row)
+			continue;
+		r = float_tab_row(tab, i);
+		v = r[col];
+		if (v == 0)
+			continue;
+		for (j = 0; j <= tab->n_col; ++j)
+			r[j] -= v * p[j];
+		r[col] = 0;
+	}
+	tab->basis[row] = col;
+}
+
+/* Perform primal simplex pivots, using Dantzig's rule, until
+ * the objective in the last row of "tab" can no longer be decreased,
+ * considering only the first "n_col" columns as entering candidates.
+ * Ties in the ratio test are broken in favor of the basic variable
+ * with the smallest column index, to avoid the most common forms
+ * of cycling, while "max_iter" guards against the remaining ones.
+ *
+ * Return 1 if an optimum was reached, 0 if the objective is unbounded or
+ * the iteration limit was reached.
+ */
+static int float_tab_minimize(struct isl_float_tab *tab, int n_col,
+	int max_iter)
+{
+	int i, j;
+	int iter;
+
+	for (iter = 0; iter < max_iter; ++iter) {
+		int row = -1, col = -1;
+		double best = -ISL_FLOAT_EPS;
+		double *d = float_tab_row(tab, tab->n_row);
+
+		for (j = 0; j < n_col; ++j)
+			if (d[j] < best) {
+				best = d[j];
+				col = j;
+			}
+		if (col < 0)
+			return 1;
+		for (i = 0; i < tab->n_row; ++i) {
+			double *r = float_tab_row(tab, i);
+			double q, q_row;
+
+			if (r[col] <= ISL_FLOAT_EPS)
+				continue;
+			if (row < 0) {
+				row = i;
+				continue;
+			}
+			q = r[tab->n_col] / r[col];
+			q_row = float_tab_row(tab, row)[tab->n_col] /
+				float_tab_row(tab, row)[col];
+			if (q < q_row - ISL_FLOAT_EPS ||
+			    (q <= q_row + ISL_FLOAT_EPS &&
+			     tab->basis[i] < tab->basis[row]))
+				row = i;
+		}
+		if (row < 0)
+			return 0;
+		float_tab_pivot(tab, row, col);
+	}
+
+	return 0;
+}
+
+/* Construct a floating point tableau for minimizing "f"
+ * over the rational points of "bmap".
+ *
+ * Each variable x_j of "bmap" is written as x_j^+ - x_j^-,
+ * with x_j^+ in column j and x_j^- in column n + j,
+ * where n is the number of variables.
+ * Each inequality constraint a_0 + a x >= 0 gets a slack variable s_i
+ * in column 2 n + i such that a x - s_i = -a_0.
+ * Rows are negated where needed to ensure a non-negative right hand side.
+ * An inequality row with a_0 >= 0 then has s_i as its initial basic
+ * variable.  The other rows get an artificial variable instead.
+ * The reduced costs are initialized to those of minimizing
+ * the sum of the artificial variables.
+ */
+static struct isl_float_tab *float_tab_from_basic_map(
+	__isl_keep isl_basic_map *bmap)
+{
+	int i, j, k;
+	int n, n_art;
+	struct isl_float_tab *tab;
+	double *d;
+
+	tab = isl_calloc_type(bmap->ctx, struct isl_float_tab);
+	if (!tab)
+		return NULL;
+	n = isl_basic_map_total_dim(bmap);
+	n_art = bmap->n_eq;
+	for (i = 0; i < bmap->n_ineq; ++i)
+		if (isl_int_is_neg(bmap->ineq[i][0]))
+			n_art++;
+	tab->n_row = bmap->n_eq + bmap->n_ineq;
+	tab->art = 2 * n + bmap->n_ineq;
+	tab->n_col = tab->art + n_art;
+	tab->a = isl_calloc_array(bmap->ctx, double,
+				(tab->n_row + 1) * (tab->n_col + 1));
+	tab->basis = isl_alloc_array(bmap->ctx, int, tab->n_row);
+	if (!tab->a || (tab->n_row && !tab->basis))
+		goto error;
+
+	k = tab->art;
+	d = float_tab_row(tab, tab->n_row);
+	for (i = 0; i < tab->n_row; ++i) {
+		int eq = i < bmap->n_eq;
+		isl_int *c = eq ? bmap->eq[i] : bmap->ineq[i - bmap->n_eq];
+		double *r = float_tab_row(tab, i);
+		double sign;
+
+		sign = !eq && !isl_int_is_neg(c[0]) ? -1 : 1;
+		if (eq && isl_int_is_pos(c[0]))
+			sign = -1;
+		for (j = 0; j < n; ++j) {
+			r[j] = sign * isl_int_get_d(c[1 + j]);
+			r[n + j] = -r[j];
+		}
+		r[tab->n_col] = -sign * isl_int_get_d(c[0]);
+		if (!eq)
+			r[2 * n + i - bmap->n_eq] = -sign;
+		if (!eq && sign < 0) {
+			tab->basis[i] = 2 * n + i - bmap->n_eq;
+			continue;
+		}
+		r[k] = 1;
+		tab->basis[i] = k++;
+		for (j = 0; j <= tab->n_col; ++j)
+			d[j] -= r[j];
+		d[tab->basis[i]] = 0;
+	}
+
+	return tab;
+error:
+	float_tab_free(tab);
+	return NULL;
+}
+
+/* Replace the reduced costs of "tab" by those of minimizing "f"
+ * (without its constant term) over the variables of "bmap".
+ */
+static void float_tab_set_objective(struct isl_float_tab *tab,
+	__isl_keep isl_basic_map *bmap, isl_int *f)
+{
+	int i, j;
+	int n = isl_basic_map_total_dim(bmap);
+	double *d = float_tab_row(tab, tab->n_row);
+
+	for (j = 0; j <= tab->n_col; ++j)
+		d[j] = 0;
+	for (j = 0; j < n; ++j) {
+		d[j] = isl_int_get_d(f[1 + j]);
+		d[n + j] = -d[j];
+	}
+	for (i = 0; i < tab->n_row; ++i) {
+		double *r = float_tab_row(tab, i);
+		double c = d[tab->basis[i]];
+
+		if (c == 0)
+			continue;
+		for (j = 0; j <= tab->n_col; ++j)
+			d[j] -= c * r[j];
+	}
+}
+
+/* Try and pivot out any artificial variables that remain in the basis
+ * (at value zero) after the first phase.
+ * If no suitable column can be found, then the row is redundant
+ * and the artificial variable simply stays in the basis.
+ */
+static void float_tab_drop_artificials(struct isl_float_tab *tab)
+{
+	int i, j;
+
+	for (i = 0; i < tab->n_row; ++i) {
+		double *r = float_tab_row(tab, i);
+
+		if (tab->basis[i] < tab->art)
+			continue;
+		for (j = 0; j < tab->art; ++j)
+			if (float_abs(r[j]) > ISL_FLOAT_EPS)
+				break;
+		if (j < tab->art)
+			float_tab_pivot(tab, i, j);
+	}
+}
+
+/* Return a basic set with as equalities the constraints of "bmap"
+ * that are tight in the basic solution described by "in_basis",
+ * i.e., the equalities and the inequalities with a non-basic slack
+ * variable, together with x_j = 0 for each variable x_j
+ * such that both x_j^+ and x_j^- are non-basic.
+ * The inequality constraints that were added are marked in "tight".
+ */
+static __isl_give isl_basic_set *basic_solution_active(
+	__isl_keep isl_basic_map *bmap, int *in_basis, int *tight)
+{
+	int i, k;
+	int n = isl_basic_map_total_dim(bmap);
+	isl_basic_set *active;
+
+	active = isl_basic_set_alloc(bmap->ctx, 0, n, 0,
+				bmap->n_eq + bmap->n_ineq + n, 0);
+	for (i = 0; i < bmap->n_eq; ++i) {
+		k = isl_basic_set_alloc_equality(active);
+		if (k < 0)
+			return isl_basic_set_free(active);
+		isl_seq_cpy(active->eq[k], bmap->eq[i], 1 + n);
+	}
+	for (i = 0; i < bmap->n_ineq; ++i) {
+		tight[i] = !in_basis[2 * n + i];
+		if (!tight[i])
+			continue;
+		k = isl_basic_set_alloc_equality(active);
+		if (k < 0)
+			return isl_basic_set_free(active);
+		isl_seq_cpy(active->eq[k], bmap->ineq[i], 1 + n);
+	}
+	for (i = 0; i < n; ++i) {
+		if (in_basis[i] || in_basis[n + i])
+			continue;
+		k = isl_basic_set_alloc_equality(active);
+		if (k < 0)
+			return isl_basic_set_free(active);
+		isl_seq_clr(active->eq[k], 1 + n);
+		isl_int_set_si(active->eq[k][1 + i], 1);
+	}
+
+	return isl_basic_set_gauss(active, NULL);
+}
+
+/* Given a basic set "bset" that has been reduced by isl_basic_set_gauss,
+ * return its single element with the common denominator in
+ * the first position, or a zero-length vector if the equalities
+ * do not determine a single element.
+ */
+static __isl_give isl_vec *unique_point(__isl_take isl_basic_set *bset)
+{
+	int i, j;
+	unsigned n;
+	isl_ctx *ctx;
+	isl_vec *v;
+	isl_int m;
+
+	if (!bset)
+		return NULL;
+	ctx = isl_basic_set_get_ctx(bset);
+	n = isl_basic_set_total_dim(bset);
+	if (ISL_F_ISSET(bset, ISL_BASIC_SET_EMPTY) || bset->n_eq != n) {
+		isl_basic_set_free(bset);
+		return isl_vec_alloc(ctx, 0);
+	}
+
+	v = isl_vec_alloc(ctx, 1 + n);
+	if (!v)
+		goto error;
+	isl_int_init(m);
+	isl_int_set_si(v->el[0], 1);
+	for (i = 0; i < n; ++i) {
+		j = isl_seq_last_non_zero(bset->eq[i] + 1, n);
+		isl_int_lcm(v->el[0], v->el[0], bset->eq[i][1 + j]);
+	}
+	for (i = 0; i < n; ++i) {
+		j = isl_seq_last_non_zero(bset->eq[i] + 1, n);
+		isl_int_divexact(m, v->el[0], bset->eq[i][1 + j]);
+		isl_int_mul(v->el[1 + j], m, bset->eq[i][0]);
+		isl_int_neg(v->el[1 + j], v->el[1 + j]);
+	}
+	isl_int_clear(m);
+
+	isl_basic_set_free(bset);
+	return v;
+error:
+	isl_basic_set_free(bset);
+	return NULL;
+}
+
+/* Is the point "x" (with its denominator in the first position)
+ * an element of "bmap", viewed as a rational set?
+ */
+static int is_rational_element(__isl_keep isl_basic_map *bmap,
+	__isl_keep isl_vec *x)
+{
+	int i;
+	int ok = 1;
+	isl_int v;
+
+	isl_int_init(v);
+	for (i = 0; ok && i < bmap->n_eq; ++i) {
+		isl_seq_inner_product(bmap->eq[i], x->el, x->size, &v);
+		ok = isl_int_is_zero(v);
+	}
+	for (i = 0; ok && i < bmap->n_ineq; ++i) {
+		isl_seq_inner_product(bmap->ineq[i], x->el, x->size, &v);
+		ok = !isl_int_is_neg(v);
+	}
+	isl_int_clear(v);
+
+	return ok;
+}
+
+/* Check that "f" can be written as a combination of the linear parts
+ * of the equality constraints of "bmap" and of the inequality constraints
+ * marked in "tight", with non-negative coefficients for the latter.
+ * If so, then any element of "bmap" on which all these constraints
+ * are tight minimizes "f", by weak duality.
+ * Only the case where the coefficients are uniquely determined
+ * is handled.  Return 0 in any other case.
+ */
+static int has_dual_certificate(__isl_keep isl_basic_map *bmap, int *tight,
+	isl_int *f)
+{
+	int i, j, k;
+	int n = isl_basic_map_total_dim(bmap);
+	int n_y;
+	int ok;
+	isl_int *c;
+	isl_basic_set *dual;
+	isl_vec *y;
+
+	n_y = bmap->n_eq;
+	for (i = 0; i < bmap->n_ineq; ++i)
+		if (tight[i])
+			n_y++;
+
+	dual = isl_basic_set_alloc(bmap->ctx, 0, n_y, 0, n, 0);
+	for (j = 0; j < n; ++j) {
+		k = isl_basic_set_alloc_equality(dual);
+		if (k < 0)
+			goto error;
+		isl_int_neg(dual->eq[k][0], f[1 + j]);
+		for (i = 0, c = dual->eq[k] + 1; i < bmap->n_eq; ++i)
+			isl_int_set(*c++, bmap->eq[i][1 + j]);
+		for (i = 0; i < bmap->n_ineq; ++i)
+			if (tight[i])
+				isl_int_set(*c++, bmap->ineq[i][1 + j]);
+	}
+	dual = isl_basic_set_gauss(dual, NULL);
+
+	y = unique_point(dual);
+	if (!y)
+		return -1;
+	ok = y->size > 0;
+	for (i = bmap->n_eq; ok && i < n_y; ++i)
+		ok = !isl_int_is_neg(y->el[1 + i]);
+	isl_vec_free(y);
+
+	return ok;
+error:
+	isl_basic_set_free(dual);
+	return -1;
+}
+
+/* Compute the minimum of "f" / "denom" over "bmap" by first solving
+ * the problem in floating point arithmetic and then recovering and
+ * verifying the corresponding optimal vertex in exact arithmetic.
+ * Return 1 if the result could be certified, 0 if it could not and
+ * -1 on error.
+ *
+ * The floating point simplex method is applied in two phases.
+ * If it finds an optimum, then the constraints that are tight
+ * in the final basis are used to compute an exact candidate
+ * solution, which is accepted if it satisfies all constraints
+ * of "bmap" and if the exact dual multipliers of the tight constraints
+ * prove its optimality.
+ * Empty and unbounded problems are never certified.
+ */
+static int float_min(__isl_keep isl_basic_map *bmap, isl_int *f,
+	isl_int denom, isl_int *opt, isl_int *opt_denom,
+	__isl_give isl_vec **sol)
+{
+	int i;
+	int ok;
+	int n_iter;
+	int *in_basis = NULL;
+	int *tight = NULL;
+	struct isl_float_tab *tab;
+	isl_basic_set *active;
+	isl_vec *x = NULL;
+	isl_int v, d;
+
+	tab = float_tab_from_basic_map(bmap);
+	if (!tab)
+		return -1;
+	n_iter = 50 * (tab->n_row + tab->n_col);
+	ok = float_tab_minimize(tab, tab->n_col, n_iter);
+	if (ok && float_tab_row(tab, tab->n_row)[tab->n_col] < -ISL_FLOAT_EPS)
+		ok = 0;
+	if (ok) {
+		float_tab_drop_artificials(tab);
+		float_tab_set_objective(tab, bmap, f);
+		ok = float_tab_minimize(tab, tab->art, n_iter);
+	}
+	if (!ok) {
+		float_tab_free(tab);
+		return 0;
+	}
+
+	in_basis = isl_calloc_array(bmap->ctx, int, tab->n_col);
+	tight = isl_alloc_array(bmap->ctx, int, bmap->n_ineq);
+	if (!in_basis || (bmap->n_ineq && !tight))
+		goto error;
+	for (i = 0; i < tab->n_row; ++i)
+		in_basis[tab->basis[i]] = 1;
+	active = basic_solution_active(bmap, in_basis, tight);
+	float_tab_free(tab);
+	tab = NULL;
+
+	x = unique_point(active);
+	if (!x)
+		goto error;
+	ok = x->size > 0 && is_rational_element(bmap, x);
+	if (ok)
+		ok = has_dual_certificate(bmap, tight, f);
+	if (ok <= 0)
+		goto done;
+
+	x = isl_vec_normalize(x);
+	if (!x)
+		goto error;
+	if (opt) {
+		isl_int_init(v);
+		isl_int_init(d);
+		isl_seq_inner_product(f, x->el, x->size, &v);
+		isl_int_mul(d, x->el[0], denom);
+		if (opt_denom) {
+			isl_int_set(*opt, v);
+			isl_int_set(*opt_denom, d);
+		} else
+			isl_int_cdiv_q(*opt, v, d);
+		isl_int_clear(d);
+		isl_int_clear(v);
+	}
+	if (sol) {
+		*sol = x;
+		x = NULL;
+	}
+done:
+	isl_vec_free(x);
+	free(tight);
+	free(in_basis);
+	return ok;
+error:
+	isl_vec_free(x);
+	free(tight);
+	free(in_basis);
+	float_tab_free(tab);
+	return -1;
+}
+
+/* Given a basic map "bmap" and an affine combination of the variables "f"
+ * with denominator "denom", set *opt / *opt_denom to the minimal
+ * (or maximal if "maximize" is true) value attained by f/d over "bmap",
+ * as in isl_tab_solve_lp, but first try to find the optimum
+ * using floating point arithmetic.
+ * If the result of the floating point computation cannot be
+ * verified to be exact, then the problem is solved again
+ * using isl_tab_solve_lp.
+ */
+enum isl_lp_result isl_float_solve_lp(__isl_keep isl_basic_map *bmap,
+	int maximize, isl_int *f, isl_int denom, isl_int *opt,
+	isl_int *opt_denom, __isl_give isl_vec **sol)
+{
+	int r;
+	unsigned dim;
+
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_EMPTY))
+		return isl_tab_solve_lp(bmap, maximize, f, denom,
+					opt, opt_denom, sol);
+
+	dim = isl_basic_map_total_dim(bmap);
+	if (maximize)
+		isl_seq_neg(f, f, 1 + dim);
+	r = float_min(bmap, f, denom, opt, opt_denom, sol);
+	if (maximize)
+		isl_seq_neg(f, f, 1 + dim);
+	if (r < 0)
+		return isl_lp_error;
+	if (r == 0)
+		return isl_tab_solve_lp(bmap, maximize, f, denom,
+					opt, opt_denom, sol);
+	if (maximize && opt)
+		isl_int_neg(*opt, *opt);
+
+	return isl_lp_ok;
+}
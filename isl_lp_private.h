@@ -5,6 +5,13 @@
 #include <isl/lp.h>
 #include <isl/vec.h>
 
+enum isl_lp_result isl_tab_solve_lp(__isl_keep isl_basic_map *bmap,
+	int maximize, isl_int *f, isl_int denom, isl_int *opt,
+	isl_int *opt_denom, __isl_give isl_vec **sol);
+enum isl_lp_result isl_float_solve_lp(__isl_keep isl_basic_map *bmap,
+	int maximize, isl_int *f, isl_int denom, isl_int *opt,
+	isl_int *opt_denom, __isl_give isl_vec **sol);
+
 enum isl_lp_result isl_basic_map_solve_lp(__isl_keep isl_basic_map *bmap,
 	int max, isl_int *f, isl_int denom, isl_int *opt, isl_int *opt_denom,
 	__isl_give isl_vec **sol);
@@ -929,6 +929,7 @@ static struct isl_basic_map *basic_map_init(struct isl_ctx *ctx,
 	bmap->n_ineq = 0;
 	bmap->n_div = 0;
 	bmap->sample = NULL;
+	bmap->shared = 0;
 
 	return bmap;
 error:
@@ -1090,6 +1091,33 @@ struct isl_map *isl_map_copy(struct isl_map *map)
 	return map;
 }
 
+static int has_same_address(const void *entry, const void *val)
+{
+	return entry == val;
+}
+
+/* Remove "bmap" from the table of shared basic maps, if it is
+ * in this table, such that it can be modified or freed.
+ * The hash value under which "bmap" was entered in the table
+ * is kept in bmap->hash since the constraints of "bmap"
+ * may have been modified in the mean time.
+ */
+static void basic_map_unshare(__isl_keep isl_basic_map *bmap)
+{
+	isl_ctx *ctx;
+	struct isl_hash_table_entry *entry;
+
+	if (!bmap->shared)
+		return;
+
+	ctx = bmap->ctx;
+	entry = isl_hash_table_find(ctx, &ctx->bmap_table, bmap->hash,
+					&has_same_address, bmap, 0);
+	if (entry)
+		isl_hash_table_remove(ctx, &ctx->bmap_table, entry);
+	bmap->shared = 0;
+}
+
 __isl_null isl_basic_map *isl_basic_map_free(__isl_take isl_basic_map *bmap)
 {
 	if (!bmap)
@@ -1098,6 +1126,7 @@ __isl_null isl_basic_map *isl_basic_map_free(__isl_take isl_basic_map *bmap)
 	if (--bmap->ref > 0)
 		return NULL;
 
+	basic_map_unshare(bmap);
 	isl_ctx_deref(bmap->ctx);
 	free(bmap->div);
 	isl_blk_free(bmap->ctx, bmap->block2);
@@ -1634,7 +1663,8 @@ struct isl_basic_map *isl_basic_map_cow(struct isl_basic_map *bmap)
 	if (bmap->ref > 1) {
 		bmap->ref--;
 		bmap = isl_basic_map_dup(bmap);
-	}
+	} else
+		basic_map_unshare(bmap);
 	if (bmap) {
 		ISL_F_CLR(bmap, ISL_BASIC_SET_FINAL);
 		ISL_F_CLR(bmap, ISL_BASIC_MAP_REDUCED_COEFFICIENTS);
@@ -2836,10 +2866,88 @@ isl_bool isl_basic_set_contains(__isl_keep isl_basic_set *bset,
 	return isl_basic_map_contains((struct isl_basic_map *)bset, vec);
 }
 
+/* Construct a candidate sample point of "bmap" from the values
+ * of the parameters, input and output dimensions in "vec",
+ * computing the values of the divs from their explicit representations.
+ * "vec" may have been a sample point of some other basic map
+ * in the same space, with different (or no) divs.
+ * Return a zero-length vector if no candidate can be constructed,
+ * i.e., if "vec" is not an integer point or if some div
+ * has no explicit representation.
+ * The caller is responsible for checking whether the candidate
+ * actually belongs to "bmap".
+ */
+static __isl_give isl_vec *lift_sample(__isl_keep isl_basic_map *bmap,
+	__isl_keep isl_vec *vec)
+{
+	int i;
+	unsigned dim, total;
+	isl_vec *sample;
+
+	if (!bmap || !vec)
+		return NULL;
+
+	dim = isl_space_dim(bmap->dim, isl_dim_all);
+	total = isl_basic_map_total_dim(bmap);
+	if (vec->size < 1 + dim || !isl_int_is_one(vec->el[0]))
+		return isl_vec_alloc(bmap->ctx, 0);
+	for (i = 0; i < bmap->n_div; ++i)
+		if (isl_int_is_zero(bmap->div[i][0]))
+			return isl_vec_alloc(bmap->ctx, 0);
+
+	sample = isl_vec_alloc(bmap->ctx, 1 + total);
+	if (!sample)
+		return NULL;
+	isl_seq_cpy(sample->el, vec->el, 1 + dim);
+	isl_seq_clr(sample->el + 1 + dim, bmap->n_div);
+	for (i = 0; i < bmap->n_div; ++i) {
+		isl_seq_inner_product(bmap->div[i] + 1, sample->el, 1 + total,
+					&sample->el[1 + dim + i]);
+		isl_int_fdiv_q(sample->el[1 + dim + i],
+				sample->el[1 + dim + i], bmap->div[i][0]);
+	}
+
+	return sample;
+}
+
+/* Try and use "vec", a sample point of some basic map in the same
+ * space as "bmap", as the sample point of "bmap".
+ * The values of the divs are recomputed for "bmap" and the result
+ * is only kept if it satisfies the constraints of "bmap".
+ * Return 1 if "bmap" has been assigned a sample point, 0 if not and
+ * -1 on error.
+ */
+static int try_lifted_sample(__isl_keep isl_basic_map *bmap,
+	__isl_keep isl_vec *vec)
+{
+	isl_bool contains;
+	isl_vec *sample;
+
+	if (!vec)
+		return 0;
+	sample = lift_sample(bmap, vec);
+	if (!sample)
+		return -1;
+	if (sample->size == 0) {
+		isl_vec_free(sample);
+		return 0;
+	}
+	contains = isl_basic_map_contains(bmap, sample);
+	if (contains < 0 || !contains) {
+		isl_vec_free(sample);
+		return contains < 0 ? -1 : 0;
+	}
+	isl_vec_free(bmap->sample);
+	bmap->sample = sample;
+	return 1;
+}
+
 struct isl_basic_map *isl_basic_map_intersect(
 		struct isl_basic_map *bmap1, struct isl_basic_map *bmap2)
 {
+	int lifted;
 	struct isl_vec *sample = NULL;
+	isl_vec *sample1 = NULL, *sample2 = NULL;
 
 	if (!bmap1 || !bmap2)
 		goto error;
@@ -2865,6 +2973,10 @@ struct isl_basic_map *isl_basic_map_intersect(
 	    isl_basic_map_contains(bmap1, bmap2->sample) > 0 &&
 	    isl_basic_map_contains(bmap2, bmap2->sample) > 0)
 		sample = isl_vec_copy(bmap2->sample);
+	else {
+		sample1 = isl_vec_copy(bmap1->sample);
+		sample2 = isl_vec_copy(bmap2->sample);
+	}
 
 	bmap1 = isl_basic_map_cow(bmap1);
 	if (!bmap1)
@@ -2878,13 +2990,23 @@ struct isl_basic_map *isl_basic_map_intersect(
 	else if (sample) {
 		isl_vec_free(bmap1->sample);
 		bmap1->sample = sample;
+	} else {
+		lifted = try_lifted_sample(bmap1, sample1);
+		if (lifted == 0)
+			lifted = try_lifted_sample(bmap1, sample2);
+		if (lifted < 0)
+			bmap1 = isl_basic_map_free(bmap1);
 	}
+	isl_vec_free(sample1);
+	isl_vec_free(sample2);
 
 	bmap1 = isl_basic_map_simplify(bmap1);
 	return isl_basic_map_finalize(bmap1);
 error:
 	if (sample)
 		isl_vec_free(sample);
+	isl_vec_free(sample1);
+	isl_vec_free(sample2);
 	isl_basic_map_free(bmap1);
 	isl_basic_map_free(bmap2);
 	return NULL;
@@ -6485,7 +6607,7 @@ static struct isl_set *set_parameter_preimage(
 
 	dim->nparam = 0;
 	dim->n_out = nparam;
-	isl_set_reset_space(set, dim);
+	set = isl_set_reset_space(set, dim);
 	set = isl_set_preimage(set, mat);
 	if (!set)
 		goto error2;
@@ -6495,7 +6617,7 @@ static struct isl_set *set_parameter_preimage(
 		goto error2;
 	dim->nparam = dim->n_out;
 	dim->n_out = 0;
-	isl_set_reset_space(set, dim);
+	set = isl_set_reset_space(set, dim);
 	return set;
 error:
 	isl_space_free(dim);
@@ -7910,6 +8032,13 @@ isl_bool isl_basic_map_is_empty(__isl_keep isl_basic_map *bmap)
 		if (contains)
 			return isl_bool_false;
 	}
+	if (bmap->sample) {
+		int lifted = try_lifted_sample(bmap, bmap->sample);
+		if (lifted < 0)
+			return isl_bool_error;
+		if (lifted)
+			return isl_bool_false;
+	}
 	isl_vec_free(bmap->sample);
 	bmap->sample = NULL;
 	bset = isl_basic_map_underlying_set(isl_basic_map_copy(bmap));
@@ -8990,21 +9119,113 @@ __isl_give isl_map *isl_map_remove_obvious_duplicates(__isl_take isl_map *map)
 	return map;
 }
 
+/* Compute a hash value for the constraints of "bmap",
+ * assuming it has already been normalized.
+ */
+static uint32_t normalized_basic_map_get_hash(__isl_keep isl_basic_map *bmap)
+{
+	int i;
+	uint32_t hash = isl_hash_init();
+	unsigned total;
+
+	total = isl_basic_map_total_dim(bmap);
+	isl_hash_byte(hash, bmap->n_eq & 0xFF);
+	for (i = 0; i < bmap->n_eq; ++i) {
+		uint32_t c_hash;
+		c_hash = isl_seq_get_hash(bmap->eq[i], 1 + total);
+		isl_hash_hash(hash, c_hash);
+	}
+	isl_hash_byte(hash, bmap->n_ineq & 0xFF);
+	for (i = 0; i < bmap->n_ineq; ++i) {
+		uint32_t c_hash;
+		c_hash = isl_seq_get_hash(bmap->ineq[i], 1 + total);
+		isl_hash_hash(hash, c_hash);
+	}
+	isl_hash_byte(hash, bmap->n_div & 0xFF);
+	for (i = 0; i < bmap->n_div; ++i) {
+		uint32_t c_hash;
+		if (isl_int_is_zero(bmap->div[i][0]))
+			continue;
+		isl_hash_byte(hash, i & 0xFF);
+		c_hash = isl_seq_get_hash(bmap->div[i], 1 + 1 + total);
+		isl_hash_hash(hash, c_hash);
+	}
+	return hash;
+}
+
+/* Is the basic map "entry" in the table of shared basic maps
+ * plainly equal to the basic map "val"?
+ * The names of all dimensions need to be the same as well
+ * since the shared object replaces "val" completely.
+ */
+static int has_equal_basic_map(const void *entry, const void *val)
+{
+	isl_basic_map *bmap1 = (isl_basic_map *) entry;
+	isl_basic_map *bmap2 = (isl_basic_map *) val;
+
+	if (isl_space_has_equal_ids(bmap1->dim, bmap2->dim) != isl_bool_true)
+		return 0;
+	return isl_basic_map_plain_cmp(bmap1, bmap2) == 0;
+}
+
+/* Replace the normalized basic map "bmap" by an identical basic map
+ * from the table of shared basic maps of its context, if any,
+ * and add "bmap" itself to this table otherwise.
+ * This ensures that identical normalized basic maps are represented
+ * by the same object, such that they can be compared by address
+ * and only need to be stored once.
+ * The table does not hold a reference to the basic maps in the table.
+ * Instead, a basic map is removed from the table when it is freed
+ * or about to be modified.
+ */
+static __isl_give isl_basic_map *basic_map_share(
+	__isl_take isl_basic_map *bmap)
+{
+	isl_ctx *ctx;
+	uint32_t hash;
+	struct isl_hash_table_entry *entry;
+
+	if (!bmap || bmap->shared)
+		return bmap;
+
+	ctx = bmap->ctx;
+	hash = normalized_basic_map_get_hash(bmap);
+	entry = isl_hash_table_find(ctx, &ctx->bmap_table, hash,
+					&has_equal_basic_map, bmap, 1);
+	if (!entry)
+		return isl_basic_map_free(bmap);
+	if (entry->data) {
+		isl_basic_map_free(bmap);
+		return isl_basic_map_copy(entry->data);
+	}
+	entry->data = bmap;
+	bmap->shared = 1;
+	bmap->hash = hash;
+	return bmap;
+}
+
 /* We normalize in place, but if anything goes wrong we need
  * to return NULL, so we need to make sure we don't change the
  * meaning of any possible other copies of map.
+ *
+ * If the share-basic-maps option is set, then each normalized
+ * basic map is replaced by an identical shared basic map, if any.
  */
 __isl_give isl_map *isl_map_normalize(__isl_take isl_map *map)
 {
 	int i;
+	int share;
 	struct isl_basic_map *bmap;
 
 	if (!map)
 		return NULL;
 	if (ISL_F_ISSET(map, ISL_MAP_NORMALIZED))
 		return map;
+	share = map->ctx->opt->share_basic_maps;
 	for (i = 0; i < map->n; ++i) {
 		bmap = isl_basic_map_normalize(isl_basic_map_copy(map->p[i]));
+		if (share)
+			bmap = basic_map_share(bmap);
 		if (!bmap)
 			goto error;
 		isl_basic_map_free(map->p[i]);
@@ -9682,9 +9903,7 @@ __isl_give isl_map *isl_map_flat_range_product(__isl_take isl_map *map1,
 
 uint32_t isl_basic_map_get_hash(__isl_keep isl_basic_map *bmap)
 {
-	int i;
-	uint32_t hash = isl_hash_init();
-	unsigned total;
+	uint32_t hash;
 
 	if (!bmap)
 		return 0;
@@ -9692,28 +9911,7 @@ uint32_t isl_basic_map_get_hash(__isl_keep isl_basic_map *bmap)
 	bmap = isl_basic_map_normalize(bmap);
 	if (!bmap)
 		return 0;
-	total = isl_basic_map_total_dim(bmap);
-	isl_hash_byte(hash, bmap->n_eq & 0xFF);
-	for (i = 0; i < bmap->n_eq; ++i) {
-		uint32_t c_hash;
-		c_hash = isl_seq_get_hash(bmap->eq[i], 1 + total);
-		isl_hash_hash(hash, c_hash);
-	}
-	isl_hash_byte(hash, bmap->n_ineq & 0xFF);
-	for (i = 0; i < bmap->n_ineq; ++i) {
-		uint32_t c_hash;
-		c_hash = isl_seq_get_hash(bmap->ineq[i], 1 + total);
-		isl_hash_hash(hash, c_hash);
-	}
-	isl_hash_byte(hash, bmap->n_div & 0xFF);
-	for (i = 0; i < bmap->n_div; ++i) {
-		uint32_t c_hash;
-		if (isl_int_is_zero(bmap->div[i][0]))
-			continue;
-		isl_hash_byte(hash, i & 0xFF);
-		c_hash = isl_seq_get_hash(bmap->div[i], 1 + 1 + total);
-		isl_hash_hash(hash, c_hash);
-	}
+	hash = normalized_basic_map_get_hash(bmap);
 	isl_basic_map_free(bmap);
 	return hash;
 }
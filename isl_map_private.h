@@ -31,6 +31,9 @@
  * n_in is the number of in variables
  * n_out is the number of out variables
  * n_in + n_out should be equal to set.dim
+ *
+ * "shared" is set if the basic map appears in the table
+ * of shared basic maps of the context, under hash value "hash".
  */
 struct isl_basic_map {
 	int ref;
@@ -72,6 +75,9 @@ struct isl_basic_map {
 
 	struct isl_vec *sample;
 
+	int shared;
+	uint32_t hash;
+
 	struct isl_blk block;
 	struct isl_blk block2;
 };
@@ -248,6 +254,7 @@ struct isl_basic_map *isl_basic_map_cow(struct isl_basic_map *bmap);
 struct isl_set *isl_set_cow(struct isl_set *set);
 struct isl_map *isl_map_cow(struct isl_map *map);
 
+struct isl_basic_map *isl_basic_map_normalize(struct isl_basic_map *bmap);
 uint32_t isl_basic_map_get_hash(__isl_keep isl_basic_map *bmap);
 
 struct isl_basic_map *isl_basic_map_set_to_empty(struct isl_basic_map *bmap);
@@ -14,6 +14,7 @@
 
 #include <isl_ctx_private.h>
 #include <isl_map_private.h>
+#include <isl_options_private.h>
 #include "isl_equalities.h"
 #include <isl/map.h>
 #include <isl_seq.h>
@@ -510,19 +511,16 @@ static __isl_give isl_basic_map *normalize_div_expressions(
 	return bmap;
 }
 
-/* Assumes divs have been ordered if keep_divs is set.
+/* Eliminate the variable at position "pos" from the equalities
+ * of "bmap" other than "eq" using the equality "eq".
  */
-static void eliminate_var_using_equality(struct isl_basic_map *bmap,
-	unsigned pos, isl_int *eq, int keep_divs, int *progress)
+static void eliminate_var_from_equalities(__isl_keep isl_basic_map *bmap,
+	unsigned pos, isl_int *eq, int *progress)
 {
 	unsigned total;
-	unsigned space_total;
 	int k;
-	int last_div;
 
 	total = isl_basic_map_total_dim(bmap);
-	space_total = isl_space_dim(bmap->dim, isl_dim_all);
-	last_div = isl_seq_last_non_zero(eq + 1 + space_total, bmap->n_div);
 	for (k = 0; k < bmap->n_eq; ++k) {
 		if (bmap->eq[k] == eq)
 			continue;
@@ -533,7 +531,18 @@ static void eliminate_var_using_equality(struct isl_basic_map *bmap,
 		isl_seq_elim(bmap->eq[k], eq, 1+pos, 1+total, NULL);
 		isl_seq_normalize(bmap->ctx, bmap->eq[k], 1 + total);
 	}
+}
 
+/* Eliminate the variable at position "pos" from the inequalities
+ * of "bmap" using the equality "eq".
+ */
+static void eliminate_var_from_inequalities(__isl_keep isl_basic_map *bmap,
+	unsigned pos, isl_int *eq, int *progress)
+{
+	unsigned total;
+	int k;
+
+	total = isl_basic_map_total_dim(bmap);
 	for (k = 0; k < bmap->n_ineq; ++k) {
 		if (isl_int_is_zero(bmap->ineq[k][1+pos]))
 			continue;
@@ -543,7 +552,23 @@ static void eliminate_var_using_equality(struct isl_basic_map *bmap,
 		isl_seq_normalize(bmap->ctx, bmap->ineq[k], 1 + total);
 		ISL_F_CLR(bmap, ISL_BASIC_MAP_NORMALIZED);
 	}
+}
+
+/* Eliminate the variable at position "pos" from the div expressions
+ * of "bmap" using the equality "eq".
+ * Assumes divs have been ordered if keep_divs is set.
+ */
+static void eliminate_var_from_divs(__isl_keep isl_basic_map *bmap,
+	unsigned pos, isl_int *eq, int keep_divs, int *progress)
+{
+	unsigned total;
+	unsigned space_total;
+	int k;
+	int last_div;
 
+	total = isl_basic_map_total_dim(bmap);
+	space_total = isl_space_dim(bmap->dim, isl_dim_all);
+	last_div = isl_seq_last_non_zero(eq + 1 + space_total, bmap->n_div);
 	for (k = 0; k < bmap->n_div; ++k) {
 		if (isl_int_is_zero(bmap->div[k][0]))
 			continue;
@@ -568,6 +593,54 @@ static void eliminate_var_using_equality(struct isl_basic_map *bmap,
 	}
 }
 
+/* Assumes divs have been ordered if keep_divs is set.
+ */
+static void eliminate_var_using_equality(struct isl_basic_map *bmap,
+	unsigned pos, isl_int *eq, int keep_divs, int *progress)
+{
+	eliminate_var_from_equalities(bmap, pos, eq, progress);
+	eliminate_var_from_inequalities(bmap, pos, eq, progress);
+	eliminate_var_from_divs(bmap, pos, eq, keep_divs, progress);
+}
+
+/* Eliminate the pivots of the first "n_eq" equalities of "bmap"
+ * from all inequalities in a single sweep over the inequalities.
+ * The first "n_eq" equalities are assumed to be in reduced echelon form,
+ * with the pivot of equality k at position pivot[k],
+ * such that the pivot of each equality does not appear in any
+ * of the other equalities.
+ * Eliminating one pivot from an inequality therefore does not
+ * reintroduce any of the other pivots and the result
+ * (after normalization) is the same as that of eliminating
+ * the pivots one by one using eliminate_var_from_inequalities.
+ * Each inequality is only normalized once at the end, though.
+ */
+static void eliminate_pivots_from_inequalities(__isl_keep isl_basic_map *bmap,
+	int n_eq, int *pivot, int *progress)
+{
+	unsigned total;
+	int i, k;
+	int modified;
+
+	total = isl_basic_map_total_dim(bmap);
+	for (i = 0; i < bmap->n_ineq; ++i) {
+		modified = 0;
+		for (k = 0; k < n_eq; ++k) {
+			if (isl_int_is_zero(bmap->ineq[i][1 + pivot[k]]))
+				continue;
+			isl_seq_elim(bmap->ineq[i], bmap->eq[k],
+					1 + pivot[k], 1 + total, NULL);
+			modified = 1;
+		}
+		if (!modified)
+			continue;
+		if (progress)
+			*progress = 1;
+		isl_seq_normalize(bmap->ctx, bmap->ineq[i], 1 + total);
+		ISL_F_CLR(bmap, ISL_BASIC_MAP_NORMALIZED);
+	}
+}
+
 /* Assumes divs have been ordered if keep_divs is set.
  */
 static __isl_give isl_basic_map *eliminate_div(__isl_take isl_basic_map *bmap,
@@ -682,6 +755,42 @@ static struct isl_basic_map *eliminate_divs_ineq(
 	return bmap;
 }
 
+/* Eliminate the pivots of the first "n_eq" equalities of "bmap",
+ * which are assumed to be in reduced echelon form, from the inequalities.
+ */
+static __isl_give isl_basic_map *eliminate_echelon_from_inequalities(
+	__isl_take isl_basic_map *bmap, int n_eq, int *progress)
+{
+	int k;
+	int *pivot;
+	unsigned total;
+
+	if (!bmap)
+		return NULL;
+	if (n_eq == 0 || bmap->n_ineq == 0)
+		return bmap;
+
+	pivot = isl_alloc_array(bmap->ctx, int, n_eq);
+	if (!pivot)
+		return isl_basic_map_free(bmap);
+	total = isl_basic_map_total_dim(bmap);
+	for (k = 0; k < n_eq; ++k)
+		pivot[k] = isl_seq_last_non_zero(bmap->eq[k] + 1, total);
+	eliminate_pivots_from_inequalities(bmap, n_eq, pivot, progress);
+	free(pivot);
+
+	return bmap;
+}
+
+/* Perform Gaussian elimination on the equalities of "bmap",
+ * bringing them into reduced echelon form, and use the result
+ * to eliminate the pivots from the inequalities and div expressions.
+ *
+ * The elimination from the equalities and div expressions is performed
+ * as soon as the pivot of an equality has been determined.
+ * The pivots are only eliminated from the inequalities at the end,
+ * in a single sweep over the inequalities.
+ */
 struct isl_basic_map *isl_basic_map_gauss(
 	struct isl_basic_map *bmap, int *progress)
 {
@@ -715,7 +824,9 @@ struct isl_basic_map *isl_basic_map_gauss(
 		if (isl_int_is_neg(bmap->eq[done][1+last_var]))
 			isl_seq_neg(bmap->eq[done], bmap->eq[done], 1+total);
 
-		eliminate_var_using_equality(bmap, last_var, bmap->eq[done], 1,
+		eliminate_var_from_equalities(bmap, last_var, bmap->eq[done],
+						progress);
+		eliminate_var_from_divs(bmap, last_var, bmap->eq[done], 1,
 						progress);
 
 		if (last_var >= total_var &&
@@ -730,6 +841,9 @@ struct isl_basic_map *isl_basic_map_gauss(
 			ISL_F_CLR(bmap, ISL_BASIC_MAP_NORMALIZED);
 		}
 	}
+	bmap = eliminate_echelon_from_inequalities(bmap, done, progress);
+	if (!bmap)
+		return NULL;
 	if (done == bmap->n_eq)
 		return bmap;
 	for (k = done; k < bmap->n_eq; ++k) {
@@ -2449,6 +2563,204 @@ error:
 	return NULL;
 }
 
+/* Compute the gist of "map" with respect to "context",
+ * where we know that neither is the universe and that they are not
+ * obviously equal to each other.
+ *
+ * During this computation, we make use of a single disjunct context,
+ * so if the original context consists of more than one disjunct
+ * then we need to approximate the context by a single disjunct set.
+ * Simply taking the simple hull may drop constraints that are
+ * only implicitly available in each disjunct.  We therefore also
+ * look for constraints among those defining "map" that are valid
+ * for the context.  These can then be used to simplify away
+ * the corresponding constraints in "map".
+ */
+static __isl_give isl_map *map_gist_compute(__isl_take isl_map *map,
+	__isl_take isl_map *context)
+{
+	isl_basic_map *hull;
+
+	context = isl_map_compute_divs(context);
+	if (!context)
+		goto error;
+	if (isl_map_n_basic_map(context) == 1) {
+		hull = isl_map_simple_hull(context);
+	} else {
+		isl_ctx *ctx;
+		isl_map_list *list;
+
+		ctx = isl_map_get_ctx(map);
+		list = isl_map_list_alloc(ctx, 2);
+		list = isl_map_list_add(list, isl_map_copy(context));
+		list = isl_map_list_add(list, isl_map_copy(map));
+		hull = isl_map_unshifted_simple_hull_from_map_list(context,
+								    list);
+	}
+	return isl_map_gist_basic_map(map, hull);
+error:
+	isl_map_free(map);
+	isl_map_free(context);
+	return NULL;
+}
+
+/* Free the entries in the cache of results of isl_map_gist of "ctx".
+ */
+void isl_ctx_clear_gist_cache(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ctx->n_gist_cache; ++i) {
+		isl_map_free(ctx->gist_cache[i].map);
+		isl_map_free(ctx->gist_cache[i].context);
+		isl_map_free(ctx->gist_cache[i].gist);
+	}
+	free(ctx->gist_cache);
+	ctx->gist_cache = NULL;
+	ctx->n_gist_cache = 0;
+}
+
+/* Are "map1" and "map2" plainly equal and do they have the same
+ * names for all their dimensions?
+ * isl_map_plain_is_equal only compares the names of the parameters,
+ * while the gist stored in a cache entry has the names of the cached map.
+ */
+static isl_bool gist_cache_key_is_equal(__isl_keep isl_map *map1,
+	__isl_keep isl_map *map2)
+{
+	isl_bool equal;
+
+	equal = isl_space_has_equal_ids(map1->dim, map2->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	return isl_map_plain_is_equal(map1, map2);
+}
+
+/* Look for an entry in the gist cache of "ctx" with hash value "hash"
+ * for a map and context that are plainly equal to "map" and "context",
+ * including the names of all their dimensions.
+ * If there is such an entry, then return a copy of the corresponding
+ * gist in "gist" and move the entry to the front of the cache.
+ * The entries in the cache are kept in order of most recent use.
+ */
+static isl_bool gist_cache_find(isl_ctx *ctx, uint32_t hash,
+	__isl_keep isl_map *map, __isl_keep isl_map *context,
+	__isl_give isl_map **gist)
+{
+	int i, j;
+	isl_bool equal;
+	struct isl_gist_cache_entry entry;
+
+	for (i = 0; i < ctx->n_gist_cache; ++i) {
+		if (ctx->gist_cache[i].hash != hash)
+			continue;
+		equal = gist_cache_key_is_equal(ctx->gist_cache[i].map, map);
+		if (equal >= 0 && equal)
+			equal = gist_cache_key_is_equal(
+					ctx->gist_cache[i].context, context);
+		if (equal < 0)
+			return isl_bool_error;
+		if (equal)
+			break;
+	}
+	if (i >= ctx->n_gist_cache)
+		return isl_bool_false;
+
+	entry = ctx->gist_cache[i];
+	for (j = i; j > 0; --j)
+		ctx->gist_cache[j] = ctx->gist_cache[j - 1];
+	ctx->gist_cache[0] = entry;
+
+	*gist = isl_map_copy(entry.gist);
+	return isl_bool_true;
+}
+
+/* Add an entry to the front of the gist cache of "ctx" recording
+ * that "gist" is the gist of "map" with respect to "context",
+ * where "hash" combines the hash values of "map" and "context".
+ * If the cache is full, then the least recently used entries
+ * are removed first.
+ */
+static isl_stat gist_cache_add(isl_ctx *ctx, uint32_t hash,
+	__isl_take isl_map *map, __isl_take isl_map *context,
+	__isl_keep isl_map *gist)
+{
+	int i, n;
+	struct isl_gist_cache_entry *cache;
+
+	if (!map || !context || !gist)
+		goto error;
+
+	n = ctx->opt->gist_cache_size;
+	while (ctx->n_gist_cache > 0 && ctx->n_gist_cache >= n) {
+		struct isl_gist_cache_entry *entry;
+
+		entry = &ctx->gist_cache[--ctx->n_gist_cache];
+		isl_map_free(entry->map);
+		isl_map_free(entry->context);
+		isl_map_free(entry->gist);
+	}
+
+	cache = isl_realloc_array(ctx, ctx->gist_cache,
+			struct isl_gist_cache_entry, ctx->n_gist_cache + 1);
+	if (!cache)
+		goto error;
+	ctx->gist_cache = cache;
+	for (i = ctx->n_gist_cache; i > 0; --i)
+		cache[i] = cache[i - 1];
+	cache[0].hash = hash;
+	cache[0].map = map;
+	cache[0].context = context;
+	cache[0].gist = isl_map_copy(gist);
+	ctx->n_gist_cache++;
+
+	return isl_stat_ok;
+error:
+	isl_map_free(map);
+	isl_map_free(context);
+	return isl_stat_error;
+}
+
+/* Compute the gist of "map" with respect to "context",
+ * reusing a previously computed result from the gist cache
+ * if the same gist was computed before.
+ * The caller has already brought "map" and "context" into
+ * normal form (by calling isl_map_plain_is_equal), such that
+ * computing their hash values is cheap.
+ */
+static __isl_give isl_map *map_gist_cached(__isl_take isl_map *map,
+	__isl_take isl_map *context)
+{
+	isl_ctx *ctx;
+	uint32_t hash;
+	isl_bool found;
+	isl_map *gist;
+
+	ctx = isl_map_get_ctx(map);
+	hash = isl_hash_init();
+	isl_hash_hash(hash, isl_map_get_hash(map));
+	isl_hash_hash(hash, isl_map_get_hash(context));
+	found = gist_cache_find(ctx, hash, map, context, &gist);
+	if (found < 0)
+		goto error;
+	if (found) {
+		ctx->stats->gist_cache_hits++;
+		isl_map_free(map);
+		isl_map_free(context);
+		return gist;
+	}
+
+	ctx->stats->gist_cache_misses++;
+	gist = map_gist_compute(isl_map_copy(map), isl_map_copy(context));
+	if (gist_cache_add(ctx, hash, map, context, gist) < 0)
+		return isl_map_free(gist);
+	return gist;
+error:
+	isl_map_free(map);
+	isl_map_free(context);
+	return NULL;
+}
+
 /* Return a map that has the same intersection with "context" as "map"
  * and that is as "simple" as possible.
  *
@@ -2459,21 +2771,14 @@ error:
  * return the corresponding universe.
  *
  * If none of these cases apply, we have to work a bit harder.
- * During this computation, we make use of a single disjunct context,
- * so if the original context consists of more than one disjunct
- * then we need to approximate the context by a single disjunct set.
- * Simply taking the simple hull may drop constraints that are
- * only implicitly available in each disjunct.  We therefore also
- * look for constraints among those defining "map" that are valid
- * for the context.  These can then be used to simplify away
- * the corresponding constraints in "map".
+ * If the gist-cache-size option is positive, then the result
+ * is looked up in and stored in the gist cache.
  */
 static __isl_give isl_map *map_gist(__isl_take isl_map *map,
 	__isl_take isl_map *context)
 {
 	int equal;
 	int is_universe;
-	isl_basic_map *hull;
 
 	is_universe = isl_map_plain_is_universe(map);
 	if (is_universe >= 0 && !is_universe)
@@ -2495,23 +2800,9 @@ static __isl_give isl_map *map_gist(__isl_take isl_map *map,
 		return res;
 	}
 
-	context = isl_map_compute_divs(context);
-	if (!context)
-		goto error;
-	if (isl_map_n_basic_map(context) == 1) {
-		hull = isl_map_simple_hull(context);
-	} else {
-		isl_ctx *ctx;
-		isl_map_list *list;
-
-		ctx = isl_map_get_ctx(map);
-		list = isl_map_list_alloc(ctx, 2);
-		list = isl_map_list_add(list, isl_map_copy(context));
-		list = isl_map_list_add(list, isl_map_copy(map));
-		hull = isl_map_unshifted_simple_hull_from_map_list(context,
-								    list);
-	}
-	return isl_map_gist_basic_map(map, hull);
+	if (isl_map_get_ctx(map)->opt->gist_cache_size > 0)
+		return map_gist_cached(map, context);
+	return map_gist_compute(map, context);
 error:
 	isl_map_free(map);
 	isl_map_free(context);
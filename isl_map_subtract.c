@@ -258,6 +258,229 @@ struct isl_diff_collector {
 		    __isl_take isl_basic_map *bmap);
 };
 
+/* A box containing all integer points of a basic map,
+ * derived from the constraints of the basic map that involve
+ * a single (non-div) variable.
+ * "bound" contains a lower bound at position 2 * k and an upper bound
+ * at position 2 * k + 1 for each variable k.
+ * "known" is set for those bounds that are known.
+ * If "valid" is not set, then no bounds could be derived.
+ */
+struct isl_diff_box {
+	int valid;
+	isl_vec *bound;
+	int *known;
+};
+
+/* Update "box" based on a constraint with constant term "c0" and
+ * coefficient "a" for variable "pos" (and zero coefficients for
+ * all other variables).  If "eq" is set, then the constraint
+ * is an equality.  That is, the constraint is c0 + a x >= 0
+ * or c0 + a x = 0.
+ * All variables are integer, so the bounds are rounded towards
+ * the inside of the box, i.e., the lower bound is
+ * ceil(-c0/a) = -floor(c0/a) and the upper bound is
+ * floor(-c0/a) = -ceil(c0/a).
+ * "t" is a temporary variable.
+ */
+static void diff_box_add_bound(struct isl_diff_box *box, int pos,
+	isl_int c0, isl_int a, int eq, isl_int t)
+{
+	isl_int *bound = box->bound->el;
+	int *known = box->known;
+
+	if (isl_int_is_pos(a) || eq) {
+		isl_int_fdiv_q(t, c0, a);
+		isl_int_neg(t, t);
+		if (!known[2 * pos] || isl_int_gt(t, bound[2 * pos]))
+			isl_int_set(bound[2 * pos], t);
+		known[2 * pos] = 1;
+	}
+	if (isl_int_is_neg(a) || eq) {
+		isl_int_cdiv_q(t, c0, a);
+		isl_int_neg(t, t);
+		if (!known[2 * pos + 1] || isl_int_lt(t, bound[2 * pos + 1]))
+			isl_int_set(bound[2 * pos + 1], t);
+		known[2 * pos + 1] = 1;
+	}
+}
+
+/* Update "box" based on the constraints "c" of length "len"
+ * of a basic map with "n_var" non-div variables
+ * that involve a single non-div variable.
+ */
+static void diff_box_add_constraints(struct isl_diff_box *box,
+	isl_int **c, int n, unsigned n_var, unsigned len, int eq, isl_int t)
+{
+	int i, pos;
+
+	for (i = 0; i < n; ++i) {
+		pos = isl_seq_first_non_zero(c[i] + 1, len);
+		if (pos < 0 || pos >= n_var)
+			continue;
+		if (isl_seq_first_non_zero(c[i] + 1 + pos + 1,
+					    len - pos - 1) != -1)
+			continue;
+		diff_box_add_bound(box, pos, c[i][0], c[i][1 + pos], eq, t);
+	}
+}
+
+/* Compute the box of "bmap".
+ * No box is computed for rational basic maps since
+ * the bounds are rounded under the assumption that
+ * all variables are integer.
+ */
+static isl_stat diff_box_init(struct isl_diff_box *box,
+	__isl_keep isl_basic_map *bmap)
+{
+	unsigned n_var, len;
+	isl_int t;
+
+	box->valid = 0;
+	box->bound = NULL;
+	box->known = NULL;
+	if (ISL_F_ISSET(bmap, ISL_BASIC_MAP_RATIONAL))
+		return isl_stat_ok;
+
+	n_var = isl_space_dim(bmap->dim, isl_dim_all);
+	len = isl_basic_map_total_dim(bmap);
+	box->bound = isl_vec_alloc(bmap->ctx, 2 * n_var);
+	box->known = isl_calloc_array(bmap->ctx, int, 2 * n_var);
+	if (!box->bound || (n_var && !box->known))
+		return isl_stat_error;
+
+	isl_int_init(t);
+	diff_box_add_constraints(box, bmap->eq, bmap->n_eq, n_var, len, 1, t);
+	diff_box_add_constraints(box, bmap->ineq, bmap->n_ineq, n_var, len,
+				0, t);
+	isl_int_clear(t);
+	box->valid = 1;
+
+	return isl_stat_ok;
+}
+
+/* Free the boxes in "boxes" of length "n".
+ */
+static void diff_boxes_free(struct isl_diff_box *boxes, int n)
+{
+	int i;
+
+	if (!boxes)
+		return;
+	for (i = 0; i < n; ++i) {
+		isl_vec_free(boxes[i].bound);
+		free(boxes[i].known);
+	}
+	free(boxes);
+}
+
+/* Compute the boxes of the basic maps in "map".
+ * The caller is responsible for only calling this function
+ * on a map with at least one basic map, such that a NULL result
+ * can only mean that an error occurred.
+ */
+static struct isl_diff_box *diff_boxes_alloc(__isl_keep isl_map *map)
+{
+	int i;
+	struct isl_diff_box *boxes;
+
+	if (!map)
+		return NULL;
+	if (map->n == 0)
+		isl_die(map->ctx, isl_error_internal,
+			"no basic maps to compute boxes of", return NULL);
+	boxes = isl_calloc_array(map->ctx, struct isl_diff_box, map->n);
+	if (!boxes)
+		return NULL;
+	for (i = 0; i < map->n; ++i)
+		if (diff_box_init(&boxes[i], map->p[i]) < 0)
+			break;
+	if (i < map->n) {
+		diff_boxes_free(boxes, i + 1);
+		return NULL;
+	}
+	return boxes;
+}
+
+/* Are the boxes "box1" and "box2" disjoint?
+ * That is, is there any variable for which the lower bound in one box
+ * is greater than the upper bound in the other box?
+ */
+static int diff_boxes_disjoint(struct isl_diff_box *box1,
+	struct isl_diff_box *box2)
+{
+	int k, n;
+	isl_int *b1, *b2;
+
+	if (!box1->valid || !box2->valid)
+		return 0;
+
+	n = box1->bound->size / 2;
+	b1 = box1->bound->el;
+	b2 = box2->bound->el;
+	for (k = 0; k < n; ++k) {
+		if (box1->known[2 * k] && box2->known[2 * k + 1] &&
+		    isl_int_gt(b1[2 * k], b2[2 * k + 1]))
+			return 1;
+		if (box2->known[2 * k] && box1->known[2 * k + 1] &&
+		    isl_int_gt(b2[2 * k], b1[2 * k + 1]))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Remove the basic maps from "map" that are obviously disjoint
+ * from "bmap" based on their boxes.
+ * "boxes" contains the boxes of the basic maps in "map".
+ * If it is NULL, then "map" is returned unchanged.
+ *
+ * Removing these basic maps does not affect the outcome
+ * of basic_map_collect_diff since the constraints of such
+ * a basic map are found to be infeasible when they are added
+ * to the tableau, after which the tableau is rolled back.
+ */
+static __isl_give isl_map *drop_disjoint(__isl_take isl_map *map,
+	__isl_keep isl_basic_map *bmap, struct isl_diff_box *boxes)
+{
+	int i, n;
+	struct isl_diff_box box;
+	isl_map *res;
+
+	if (!map || !bmap)
+		return isl_map_free(map);
+	if (!boxes)
+		return map;
+
+	if (diff_box_init(&box, bmap) < 0)
+		goto error;
+
+	n = 0;
+	for (i = 0; i < map->n; ++i)
+		if (!diff_boxes_disjoint(&box, &boxes[i]))
+			++n;
+	if (n == map->n) {
+		isl_vec_free(box.bound);
+		free(box.known);
+		return map;
+	}
+
+	res = isl_map_alloc_space(isl_map_get_space(map), n, map->flags);
+	for (i = 0; i < map->n; ++i)
+		if (!diff_boxes_disjoint(&box, &boxes[i]))
+			res = isl_map_add_basic_map(res,
+					isl_basic_map_copy(map->p[i]));
+	isl_vec_free(box.bound);
+	free(box.known);
+	isl_map_free(map);
+	return res;
+error:
+	isl_vec_free(box.bound);
+	free(box.known);
+	isl_map_free(map);
+	return NULL;
+}
+
 /* Compute the set difference between bmap and map and call
  * dc->add on each of the piece until this function returns
  * a negative value.
@@ -286,9 +509,15 @@ struct isl_diff_collector {
  * and if so, pass it along to dc->add.  As a special case, if nothing
  * has been removed when we end up in a leaf, we simply pass along
  * the original basic map.
+ *
+ * "boxes" contains the boxes of the basic maps in "map" (or is NULL).
+ * The basic maps in "map" that are obviously disjoint from "bmap"
+ * based on these boxes are removed first since they would not
+ * remove anything from "bmap" anyway.
  */
 static isl_stat basic_map_collect_diff(__isl_take isl_basic_map *bmap,
-	__isl_take isl_map *map, struct isl_diff_collector *dc)
+	__isl_take isl_map *map, struct isl_diff_box *boxes,
+	struct isl_diff_collector *dc)
 {
 	int i;
 	int modified;
@@ -310,6 +539,16 @@ static isl_stat basic_map_collect_diff(__isl_take isl_basic_map *bmap,
 		return empty < 0 ? isl_stat_error : isl_stat_ok;
 	}
 
+	map = drop_disjoint(map, bmap, boxes);
+	if (map && map->n == 0) {
+		isl_map_free(map);
+		bmap = isl_basic_map_cow(bmap);
+		bmap = isl_basic_map_order_divs(bmap);
+		if (!bmap)
+			return isl_stat_error;
+		return dc->add(dc, bmap) < 0 ? isl_stat_error : isl_stat_ok;
+	}
+
 	bmap = isl_basic_map_cow(bmap);
 	map = isl_map_cow(map);
 
@@ -477,14 +716,15 @@ static int basic_map_subtract_add(struct isl_diff_collector *dc,
 }
 
 /* Return the set difference between bmap and map.
+ * "boxes" contains the boxes of the basic maps in "map".
  */
 static __isl_give isl_map *basic_map_subtract(__isl_take isl_basic_map *bmap,
-	__isl_take isl_map *map)
+	__isl_take isl_map *map, struct isl_diff_box *boxes)
 {
 	struct isl_subtract_diff_collector sdc;
 	sdc.dc.add = &basic_map_subtract_add;
 	sdc.diff = isl_map_empty(isl_basic_map_get_space(bmap));
-	if (basic_map_collect_diff(bmap, map, &sdc.dc) < 0) {
+	if (basic_map_collect_diff(bmap, map, boxes, &sdc.dc) < 0) {
 		isl_map_free(sdc.diff);
 		sdc.diff = NULL;
 	}
@@ -518,6 +758,7 @@ static __isl_give isl_map *map_subtract( __isl_take isl_map *map1,
 	int i;
 	int equal, disjoint;
 	struct isl_map *diff;
+	struct isl_diff_box *boxes;
 
 	if (!map1 || !map2)
 		goto error;
@@ -546,17 +787,25 @@ static __isl_give isl_map *map_subtract( __isl_take isl_map *map1,
 	map1 = isl_map_remove_empty_parts(map1);
 	map2 = isl_map_remove_empty_parts(map2);
 
+	boxes = NULL;
+	if (map2->n > 0) {
+		boxes = diff_boxes_alloc(map2);
+		if (!boxes)
+			goto error;
+	}
+
 	diff = isl_map_empty(isl_map_get_space(map1));
 	for (i = 0; i < map1->n; ++i) {
 		struct isl_map *d;
 		d = basic_map_subtract(isl_basic_map_copy(map1->p[i]),
-				       isl_map_copy(map2));
+				       isl_map_copy(map2), boxes);
 		if (ISL_F_ISSET(map1, ISL_MAP_DISJOINT))
 			diff = isl_map_union_disjoint(diff, d);
 		else
 			diff = isl_map_union(diff, d);
 	}
 
+	diff_boxes_free(boxes, map2->n);
 	isl_map_free(map1);
 	isl_map_free(map2);
 
@@ -656,9 +905,10 @@ static int basic_map_is_empty_add(struct isl_diff_collector *dc,
 
 /* Check if bmap \ map is empty by computing this set difference
  * and breaking off as soon as the difference is known to be non-empty.
+ * "boxes" contains the boxes of the basic maps in "map".
  */
 static isl_bool basic_map_diff_is_empty(__isl_keep isl_basic_map *bmap,
-	__isl_keep isl_map *map)
+	__isl_keep isl_map *map, struct isl_diff_box *boxes)
 {
 	isl_bool empty;
 	isl_stat r;
@@ -671,7 +921,7 @@ static isl_bool basic_map_diff_is_empty(__isl_keep isl_basic_map *bmap,
 	edc.dc.add = &basic_map_is_empty_add;
 	edc.empty = isl_bool_true;
 	r = basic_map_collect_diff(isl_basic_map_copy(bmap),
-				   isl_map_copy(map), &edc.dc);
+				   isl_map_copy(map), boxes, &edc.dc);
 	if (!edc.empty)
 		return isl_bool_false;
 
@@ -686,16 +936,25 @@ static isl_bool map_diff_is_empty(__isl_keep isl_map *map1,
 {
 	int i;
 	isl_bool is_empty = isl_bool_true;
+	struct isl_diff_box *boxes;
 
 	if (!map1 || !map2)
 		return isl_bool_error;
-	
+
+	boxes = NULL;
+	if (map2->n > 0) {
+		boxes = diff_boxes_alloc(map2);
+		if (!boxes)
+			return isl_bool_error;
+	}
+
 	for (i = 0; i < map1->n; ++i) {
-		is_empty = basic_map_diff_is_empty(map1->p[i], map2);
+		is_empty = basic_map_diff_is_empty(map1->p[i], map2, boxes);
 		if (is_empty < 0 || !is_empty)
 			 break;
 	}
 
+	diff_boxes_free(boxes, map2->n);
 	return is_empty;
 }
 
@@ -892,7 +1151,7 @@ __isl_give isl_map *isl_map_make_disjoint(__isl_take isl_map *map)
 	for (i = 1; i < map->n; ++i) {
 		struct isl_basic_map *bmap = isl_basic_map_copy(map->p[i]);
 		struct isl_map *copy = isl_map_copy(sdc.diff);
-		if (basic_map_collect_diff(bmap, copy, &sdc.dc) < 0) {
+		if (basic_map_collect_diff(bmap, copy, NULL, &sdc.dc) < 0) {
 			isl_map_free(sdc.diff);
 			sdc.diff = NULL;
 			break;
@@ -72,6 +72,18 @@ static struct isl_arg_choice convex[] = {
 	{0}
 };
 
+static struct isl_arg_choice lp_solver[] = {
+	{"tab",		ISL_LP_TAB},
+	{"float",	ISL_LP_FLOAT},
+	{0}
+};
+
+static struct isl_arg_choice ilp_solver[] = {
+	{"search",	ISL_ILP_SEARCH},
+	{"bb",		ISL_ILP_BB},
+	{0}
+};
+
 #define		ISL_SCHEDULE_FUSE_MAX			0
 #define		ISL_SCHEDULE_FUSE_MIN			1
 
@@ -130,10 +142,25 @@ ISL_ARG_BOOL(struct isl_options, bernstein_triangulate, 0,
 	"triangulate domains during Bernstein expansion")
 ISL_ARG_BOOL(struct isl_options, pip_symmetry, 0, "pip-symmetry", 1,
 	"detect simple symmetries in PIP input")
+ISL_ARG_BOOL(struct isl_options, pip_compress, 0, "pip-compress", 1,
+	"exploit equalities in the PIP context to eliminate domain variables")
 ISL_ARG_CHOICE(struct isl_options, convex, 0, "convex-hull", \
 	convex,	ISL_CONVEX_HULL_WRAP, "convex hull algorithm to use")
+ISL_ARG_CHOICE(struct isl_options, lp_solver, 0, "lp-solver", \
+	lp_solver, ISL_LP_TAB, "lp solver to use")
+ISL_ARG_CHOICE(struct isl_options, ilp_solver, 0, "ilp-solver", \
+	ilp_solver, ISL_ILP_SEARCH, "ilp solver to use")
 ISL_ARG_BOOL(struct isl_options, coalesce_bounded_wrapping, 0,
 	"coalesce-bounded-wrapping", 1, "bound wrapping during coalescing")
+ISL_ARG_BOOL(struct isl_options, share_basic_maps, 0,
+	"share-basic-maps", 0,
+	"share identical basic maps after normalization")
+ISL_ARG_INT(struct isl_options, gist_cache_size, 0,
+	"gist-cache-size", "size", 0, "number of results of isl_map_gist "
+	"to keep around for reuse")
+ISL_ARG_INT(struct isl_options, lexopt_cache_size, 0,
+	"lexopt-cache-size", "size", 0, "number of results of parametric "
+	"lexicographic optimization to keep around for reuse")
 ISL_ARG_INT(struct isl_options, schedule_max_coefficient, 0,
 	"schedule-max-coefficient", "limit", -1, "Only consider schedules "
 	"where the coefficients of the variable and parameter dimensions "
@@ -163,6 +190,10 @@ ISL_ARG_CHOICE(struct isl_options, schedule_algorithm, 0,
 ISL_ARG_BOOL(struct isl_options, schedule_serialize_sccs, 0,
 	"schedule-serialize-sccs", 0,
 	"serialize strongly connected components in dependence graph")
+ISL_ARG_INT(struct isl_options, schedule_coefficient_cache, 0,
+	"schedule-coefficient-cache", "size", 0, "number of sets of "
+	"coefficients of valid constraints to keep around for reuse "
+	"in subsequent schedule computations")
 ISL_ARG_PHANTOM_USER_CHOICE_F(0, "schedule-fuse", fuse, &set_fuse,
 	ISL_SCHEDULE_FUSE_MAX, "level of fusion during scheduling",
 	ISL_ARG_HIDDEN)
@@ -221,6 +252,36 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	coalesce_bounded_wrapping)
 
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	share_basic_maps)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	share_basic_maps)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	gist_cache_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	gist_cache_size)
+
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	lexopt_cache_size)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	lexopt_cache_size)
+
+ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	pip_compress)
+ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
+	pip_compress)
+
+ISL_CTX_SET_CHOICE_DEF(isl_options, struct isl_options, isl_options_args,
+	lp_solver)
+ISL_CTX_GET_CHOICE_DEF(isl_options, struct isl_options, isl_options_args,
+	lp_solver)
+
+ISL_CTX_SET_CHOICE_DEF(isl_options, struct isl_options, isl_options_args,
+	ilp_solver)
+ISL_CTX_GET_CHOICE_DEF(isl_options, struct isl_options, isl_options_args,
+	ilp_solver)
+
 ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	gbr_only_first)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
@@ -266,6 +327,11 @@ ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	schedule_serialize_sccs)
 
+ISL_CTX_SET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_coefficient_cache)
+ISL_CTX_GET_INT_DEF(isl_options, struct isl_options, isl_options_args,
+	schedule_coefficient_cache)
+
 ISL_CTX_SET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
 	tile_scale_tile_loops)
 ISL_CTX_GET_BOOL_DEF(isl_options, struct isl_options, isl_options_args,
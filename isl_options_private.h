@@ -28,13 +28,21 @@ struct isl_options {
 	int			bernstein_triangulate;
 
 	int			pip_symmetry;
+	int			pip_compress;
 
 	#define			ISL_CONVEX_HULL_WRAP	0
 	#define			ISL_CONVEX_HULL_FM	1
 	int			convex;
 
+	int			lp_solver;
+	int			ilp_solver;
+
 	int			coalesce_bounded_wrapping;
 
+	int			share_basic_maps;
+	int			gist_cache_size;
+	int			lexopt_cache_size;
+
 	int			schedule_max_coefficient;
 	int			schedule_max_constant_term;
 	int			schedule_parametric;
@@ -44,6 +52,7 @@ struct isl_options {
 	int			schedule_separate_components;
 	unsigned		schedule_algorithm;
 	int			schedule_serialize_sccs;
+	int			schedule_coefficient_cache;
 
 	int			tile_scale_tile_loops;
 	int			tile_shift_point_loops;
@@ -511,6 +511,8 @@ struct isl_sched_edge {
  * if compression is involved then the key for these maps
  * it the original, uncompressed dependence relation, while
  * the value is the dual of the compressed dependence relation.
+ * The caches are shared with the subgraphs created from this graph
+ * (see compute_sub_schedule) so that each dual is computed only once.
  *
  * n is the number of nodes
  * node is the list of nodes
@@ -1371,6 +1373,69 @@ static int sort_sccs(struct isl_sched_graph *graph)
 	return isl_sort(graph->sorted, graph->n, sizeof(int), &cmp_scc, graph);
 }
 
+/* Free the cache of sets of coefficients of valid constraints
+ * that is kept across schedule computations in "ctx".
+ */
+void isl_ctx_clear_schedule_cache(isl_ctx *ctx)
+{
+	ctx->schedule_coef = isl_map_to_basic_set_free(ctx->schedule_coef);
+	ctx->n_schedule_coef = 0;
+}
+
+/* Compute the set of coefficients of valid constraints for "set".
+ *
+ * If the schedule_coefficient_cache option is positive, then
+ * the result is looked up in (and added to) a cache in "ctx" that
+ * survives the current schedule computation.  This allows
+ * a subsequent schedule computation on a slightly modified set
+ * of schedule constraints to reuse the sets of coefficients
+ * of the dependence relations that have not been modified.
+ * The cache is keyed on the actual input of isl_set_coefficients
+ * such that it does not depend on any details of the dependence graph.
+ * Once the number of elements in the cache reaches the value
+ * of the option, the cache is cleared.
+ */
+static __isl_give isl_basic_set *set_coefficients(__isl_take isl_set *set)
+{
+	isl_ctx *ctx;
+	isl_bool has;
+	isl_basic_set *coef;
+
+	if (!set)
+		return NULL;
+	ctx = isl_set_get_ctx(set);
+	if (ctx->opt->schedule_coefficient_cache <= 0)
+		return isl_set_coefficients(set);
+
+	if (!ctx->schedule_coef) {
+		ctx->schedule_coef = isl_map_to_basic_set_alloc(ctx, 8);
+		if (!ctx->schedule_coef)
+			return isl_set_coefficients(set);
+	}
+	has = isl_map_to_basic_set_has(ctx->schedule_coef, (isl_map *) set);
+	if (has < 0)
+		goto error;
+	if (has)
+		return isl_map_to_basic_set_get(ctx->schedule_coef,
+						(isl_map *) set);
+
+	coef = isl_set_coefficients(isl_set_copy(set));
+	if (ctx->n_schedule_coef >= ctx->opt->schedule_coefficient_cache)
+		isl_ctx_clear_schedule_cache(ctx);
+	if (!ctx->schedule_coef)
+		ctx->schedule_coef = isl_map_to_basic_set_alloc(ctx, 8);
+	ctx->schedule_coef = isl_map_to_basic_set_set(ctx->schedule_coef,
+				(isl_map *) set, isl_basic_set_copy(coef));
+	ctx->n_schedule_coef++;
+	if (!ctx->schedule_coef)
+		return isl_basic_set_free(coef);
+
+	return coef;
+error:
+	isl_set_free(set);
+	return NULL;
+}
+
 /* Given a dependence relation R from "node" to itself,
  * construct the set of coefficients of valid constraints for elements
  * in that dependence relation.
@@ -1395,13 +1460,21 @@ static __isl_give isl_basic_set *intra_coefficients(
 	struct isl_sched_graph *graph, struct isl_sched_node *node,
 	__isl_take isl_map *map)
 {
+	isl_ctx *ctx;
 	isl_set *delta;
 	isl_map *key;
 	isl_basic_set *coef;
 
-	if (isl_map_to_basic_set_has(graph->intra_hmap, map))
+	if (!map)
+		return NULL;
+
+	ctx = isl_map_get_ctx(map);
+	if (isl_map_to_basic_set_has(graph->intra_hmap, map)) {
+		ctx->stats->schedule_coef_hits++;
 		return isl_map_to_basic_set_get(graph->intra_hmap, map);
+	}
 
+	ctx->stats->schedule_coef_misses++;
 	key = isl_map_copy(map);
 	if (node->compressed) {
 		map = isl_map_preimage_domain_multi_aff(map,
@@ -1410,7 +1483,7 @@ static __isl_give isl_basic_set *intra_coefficients(
 				    isl_multi_aff_copy(node->decompress));
 	}
 	delta = isl_set_remove_divs(isl_map_deltas(map));
-	coef = isl_set_coefficients(delta);
+	coef = set_coefficients(delta);
 	graph->intra_hmap = isl_map_to_basic_set_set(graph->intra_hmap, key,
 					isl_basic_set_copy(coef));
 
@@ -1432,13 +1505,21 @@ static __isl_give isl_basic_set *inter_coefficients(
 	struct isl_sched_graph *graph, struct isl_sched_edge *edge,
 	__isl_take isl_map *map)
 {
+	isl_ctx *ctx;
 	isl_set *set;
 	isl_map *key;
 	isl_basic_set *coef;
 
-	if (isl_map_to_basic_set_has(graph->inter_hmap, map))
+	if (!map)
+		return NULL;
+
+	ctx = isl_map_get_ctx(map);
+	if (isl_map_to_basic_set_has(graph->inter_hmap, map)) {
+		ctx->stats->schedule_coef_hits++;
 		return isl_map_to_basic_set_get(graph->inter_hmap, map);
+	}
 
+	ctx->stats->schedule_coef_misses++;
 	key = isl_map_copy(map);
 	if (edge->src->compressed)
 		map = isl_map_preimage_domain_multi_aff(map,
@@ -1447,7 +1528,7 @@ static __isl_give isl_basic_set *inter_coefficients(
 		map = isl_map_preimage_range_multi_aff(map,
 				    isl_multi_aff_copy(edge->dst->decompress));
 	set = isl_map_wrap(isl_map_remove_divs(map));
-	coef = isl_set_coefficients(set);
+	coef = set_coefficients(set);
 	graph->inter_hmap = isl_map_to_basic_set_set(graph->inter_hmap, key,
 					isl_basic_set_copy(coef));
 
@@ -2269,10 +2350,22 @@ static int needs_row(struct isl_sched_graph *graph, struct isl_sched_node *node)
  * one of the remaining components of t_i_x is non-zero, i.e.,
  * that the new schedule row depends on at least one of the remaining
  * columns of Q.
+ *
+ * "max_zero" is an upper bound on the number of initial zeros
+ * in the sums of the m_n coefficients and m_0 that can be attained.
+ * Once a solution attaining this bound has been found, the search
+ * for a better solution is stopped.
+ * If "max_zero" is smaller than 2, then it was derived from
+ * the solution for the previous row (see next_max_zero) and
+ * graph->region still holds the non-triviality regions of that row.
+ * If any node had a non-triviality region for the previous row,
+ * but does not get one for this row, then the problem is less
+ * restrictive for this node and the bound is dropped.
  */
-static __isl_give isl_vec *solve_lp(struct isl_sched_graph *graph)
+static __isl_give isl_vec *solve_lp(struct isl_sched_graph *graph,
+	int max_zero)
 {
-	int i;
+	int i, row;
 	isl_vec *sol;
 	isl_basic_set *lp;
 
@@ -2280,17 +2373,50 @@ static __isl_give isl_vec *solve_lp(struct isl_sched_graph *graph)
 		struct isl_sched_node *node = &graph->node[i];
 		int skip = node->rank;
 		graph->region[i].pos = node->start + 1 + 2*(node->nparam+skip);
-		if (needs_row(graph, node))
+		row = needs_row(graph, node);
+		if (!row && max_zero < 2 && graph->region[i].len != 0)
+			max_zero = 2;
+		if (row)
 			graph->region[i].len = 2 * (node->nvar - skip);
 		else
 			graph->region[i].len = 0;
 	}
 	lp = isl_basic_set_copy(graph->lp);
-	sol = isl_tab_basic_set_non_trivial_lexmin(lp, 2, graph->n,
+	sol = isl_tab_basic_set_non_trivial_lexmin(lp, 2, max_zero, graph->n,
 				       graph->region, &check_conflict, graph);
 	return sol;
 }
 
+/* Return an upper bound on the number of initial zeros among
+ * the first two (optimized) coordinates of a solution of the ILP problem
+ * for the next row in the current band, given that "sol" is
+ * the solution found for the current row.
+ *
+ * Within a band, the ILP problem is only expressed in terms of
+ * a different basis for the schedule coefficients.
+ * The non-triviality regions only get more restrictive
+ * as long as every node with a non-triviality region for the current row
+ * also gets one for the next row.  This is checked by solve_lp,
+ * which drops the bound otherwise.
+ * In this case, the number of initial zeros in "sol" is also attainable
+ * by the next row at best, unless the schedule coefficients are bounded.
+ * Since those bounds are imposed on the coefficients in the new basis,
+ * they can change the set of admissible schedule rows
+ * in other ways and no upper bound is derived in this case.
+ */
+static int next_max_zero(isl_ctx *ctx, __isl_keep isl_vec *sol)
+{
+	int i;
+
+	if (ctx->opt->schedule_max_coefficient != -1)
+		return 2;
+
+	for (i = 0; i < 2; ++i)
+		if (!isl_int_is_zero(sol->el[1 + i]))
+			break;
+	return i;
+}
+
 /* Update the schedules of all nodes based on the given solution
  * of the LP problem.
  * The new row is added to the current band.
@@ -2908,6 +3034,37 @@ static int copy_edges(isl_ctx *ctx, struct isl_sched_graph *dst,
 	return 0;
 }
 
+/* Let "dst" start out from the caches of duals of dependence relations
+ * of "src".
+ * The nodes of a subgraph are copies of those of the original graph,
+ * including their compression, so the cached duals remain valid.
+ * Since the caches are only referenced, any dual computed
+ * for "dst" is stored in a private copy.
+ */
+static void graph_inherit_coefficients(struct isl_sched_graph *dst,
+	struct isl_sched_graph *src)
+{
+	isl_map_to_basic_set_free(dst->intra_hmap);
+	isl_map_to_basic_set_free(dst->inter_hmap);
+	dst->intra_hmap = isl_map_to_basic_set_copy(src->intra_hmap);
+	dst->inter_hmap = isl_map_to_basic_set_copy(src->inter_hmap);
+}
+
+/* Hand the caches of duals of dependence relations of "src"
+ * back to "dst", such that the duals computed for "src" can be reused
+ * by "dst" and by any subsequent subgraph of "dst".
+ */
+static void graph_return_coefficients(struct isl_sched_graph *dst,
+	struct isl_sched_graph *src)
+{
+	isl_map_to_basic_set_free(dst->intra_hmap);
+	isl_map_to_basic_set_free(dst->inter_hmap);
+	dst->intra_hmap = src->intra_hmap;
+	dst->inter_hmap = src->inter_hmap;
+	src->intra_hmap = NULL;
+	src->inter_hmap = NULL;
+}
+
 /* Compute the maximal number of variables over all nodes.
  * This is the maximal number of linearly independent schedule
  * rows that we need to compute.
@@ -2948,6 +3105,9 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
  * be set and then we call compute_schedule_wcc on the constructed subgraph.
  * Otherwise, we call compute_schedule, which will check whether the subgraph
  * is connected.
+ * The subgraph uses the caches of duals of dependence relations
+ * of "graph" and hands them back, extended with the duals it computed,
+ * after the schedule has been computed.
  *
  * The schedule is inserted at "node" and the updated schedule node
  * is returned.
@@ -2964,6 +3124,7 @@ static __isl_give isl_schedule_node *compute_sub_schedule(
 
 	if (graph_alloc(ctx, &split, n, n_edge) < 0)
 		goto error;
+	graph_inherit_coefficients(&split, graph);
 	if (copy_nodes(&split, graph, node_pred, data) < 0)
 		goto error;
 	if (graph_init_table(ctx, &split) < 0)
@@ -2984,6 +3145,7 @@ static __isl_give isl_schedule_node *compute_sub_schedule(
 	else
 		node = compute_schedule(node, &split);
 
+	graph_return_coefficients(graph, &split);
 	graph_free(ctx, &split);
 	return node;
 error:
@@ -4077,6 +4239,13 @@ error:
  * until we are no longer able to compute a schedule.
  * Since there are only a finite number of dependences,
  * there will only be a finite number of iterations.
+ *
+ * As long as the ILP problem only changes by the addition of rows
+ * to the current band and no node drops its non-triviality region,
+ * the quality of the previous row bounds that of the next row
+ * (see next_max_zero) and this bound is used to cut short
+ * the search for the next row.
+ * The bound is dropped whenever the problem changes in any other way.
  */
 static __isl_give isl_schedule_node *compute_schedule_wcc(
 	__isl_take isl_schedule_node *node, struct isl_sched_graph *graph)
@@ -4086,6 +4255,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 	int force_coincidence = 0;
 	int check_conditional;
 	int insert;
+	int max_zero;
 	isl_ctx *ctx;
 
 	if (!node)
@@ -4111,6 +4281,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 		force_coincidence = 1;
 
 	use_coincidence = has_coincidence;
+	max_zero = 2;
 	while (graph->n_row < graph->maxvar) {
 		isl_vec *sol;
 		int violated;
@@ -4121,7 +4292,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 
 		if (setup_lp(ctx, graph, use_coincidence) < 0)
 			return isl_schedule_node_free(node);
-		sol = solve_lp(graph);
+		sol = solve_lp(graph, max_zero);
 		if (!sol)
 			return isl_schedule_node_free(node);
 		if (sol->size == 0) {
@@ -4130,6 +4301,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 			isl_vec_free(sol);
 			if (use_coincidence && (!force_coincidence || !empty)) {
 				use_coincidence = 0;
+				max_zero = 2;
 				continue;
 			}
 			if (!ctx->opt->schedule_maximize_band_depth && !empty)
@@ -4140,6 +4312,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 				return compute_next_band(node, graph, 1);
 			return carry_dependences(node, graph);
 		}
+		max_zero = next_max_zero(ctx, sol);
 		coincident = !has_coincidence || use_coincidence;
 		if (update_schedule(graph, sol, 1, coincident) < 0)
 			return isl_schedule_node_free(node);
@@ -4154,6 +4327,7 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
 		if (reset_band(graph) < 0)
 			return isl_schedule_node_free(node);
 		use_coincidence = has_coincidence;
+		max_zero = 2;
 	}
 
 	insert = graph->n_total_row > graph->band_start;
@@ -4177,13 +4351,17 @@ static __isl_give isl_schedule_node *compute_schedule_wcc(
  * weakly connected component in the dependence graph so that
  * there is no need for compute_sub_schedule to look for weakly
  * connected components.
+ *
+ * The numbers of nodes and edges in each group are computed
+ * in a single pass over the graph rather than separately
+ * for each group, since there may be many groups.
  */
 static __isl_give isl_schedule_node *compute_component_schedule(
 	__isl_take isl_schedule_node *node, struct isl_sched_graph *graph,
 	int wcc)
 {
 	int component, i;
-	int n, n_edge;
+	int *n, *n_edge;
 	isl_ctx *ctx;
 	isl_union_set_list *filters;
 
@@ -4191,6 +4369,16 @@ static __isl_give isl_schedule_node *compute_component_schedule(
 		return NULL;
 	ctx = isl_schedule_node_get_ctx(node);
 
+	n = isl_calloc_array(ctx, int, graph->scc);
+	n_edge = isl_calloc_array(ctx, int, graph->scc);
+	if (graph->scc && (!n || !n_edge))
+		goto error;
+	for (i = 0; i < graph->n; ++i)
+		n[graph->node[i].scc]++;
+	for (i = 0; i < graph->n_edge; ++i)
+		if (graph->edge[i].src->scc == graph->edge[i].dst->scc)
+			n_edge[graph->edge[i].src->scc]++;
+
 	filters = extract_sccs(ctx, graph);
 	if (graph->weak)
 		node = isl_schedule_node_insert_set(node, filters);
@@ -4198,26 +4386,23 @@ static __isl_give isl_schedule_node *compute_component_schedule(
 		node = isl_schedule_node_insert_sequence(node, filters);
 
 	for (component = 0; component < graph->scc; ++component) {
-		n = 0;
-		for (i = 0; i < graph->n; ++i)
-			if (graph->node[i].scc == component)
-				n++;
-		n_edge = 0;
-		for (i = 0; i < graph->n_edge; ++i)
-			if (graph->edge[i].src->scc == component &&
-			    graph->edge[i].dst->scc == component)
-				n_edge++;
-
 		node = isl_schedule_node_child(node, component);
 		node = isl_schedule_node_child(node, 0);
-		node = compute_sub_schedule(node, ctx, graph, n, n_edge,
+		node = compute_sub_schedule(node, ctx, graph,
+				    n[component], n_edge[component],
 				    &node_scc_exactly,
 				    &edge_scc_exactly, component, wcc);
 		node = isl_schedule_node_parent(node);
 		node = isl_schedule_node_parent(node);
 	}
 
+	free(n);
+	free(n_edge);
 	return node;
+error:
+	free(n);
+	free(n_edge);
+	return isl_schedule_node_free(node);
 }
 
 /* Compute a schedule for the given dependence graph and insert it at "node".
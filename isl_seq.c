@@ -45,20 +45,356 @@ void isl_seq_cpy(isl_int *dst, isl_int *src, unsigned len)
 		isl_int_set(dst[i], src[i]);
 }
 
-void isl_seq_submul(isl_int *dst, isl_int f, isl_int *src, unsigned len)
+static void isl_seq_submul_generic(isl_int *dst, isl_int f, isl_int *src,
+	unsigned len)
 {
 	int i;
 	for (i = 0; i < len; ++i)
 		isl_int_submul(dst[i], f, src[i]);
 }
 
-void isl_seq_addmul(isl_int *dst, isl_int f, isl_int *src, unsigned len)
+static void isl_seq_addmul_generic(isl_int *dst, isl_int f, isl_int *src,
+	unsigned len)
 {
 	int i;
 	for (i = 0; i < len; ++i)
 		isl_int_addmul(dst[i], f, src[i]);
 }
 
+/* Compute dst = m1 * src1 + m2 * src2 on the full integer representation.
+ * Elements where either of the two inputs is zero only require
+ * a single multiplication.
+ */
+static void isl_seq_combine_generic(isl_int *dst, isl_int m1, isl_int *src1,
+	isl_int m2, isl_int *src2, unsigned len)
+{
+	int i;
+	isl_int tmp;
+
+	isl_int_init(tmp);
+	for (i = 0; i < len; ++i) {
+		if (isl_int_is_zero(src2[i])) {
+			isl_int_mul(dst[i], m1, src1[i]);
+			continue;
+		}
+		if (isl_int_is_zero(src1[i])) {
+			isl_int_mul(dst[i], m2, src2[i]);
+			continue;
+		}
+		isl_int_mul(tmp, m1, src1[i]);
+		isl_int_addmul(tmp, m2, src2[i]);
+		isl_int_set(dst[i], tmp);
+	}
+	isl_int_clear(tmp);
+}
+
+#ifdef USE_SMALL_INT_OPT
+
+/* The maximal number of elements that are computed by the machine
+ * integer kernels below before the results are written back.
+ */
+#define ISL_SEQ_SMALL_CHUNK	32
+
+/* Return 1 if all "len" elements of "p" are in small representation.
+ * The discriminator bits are combined without any branching
+ * such that the compiler can vectorize the loop.
+ */
+static int isl_seq_is_small(isl_int *p, unsigned len)
+{
+	int i;
+	isl_sioimath all = 1;
+
+	for (i = 0; i < len; ++i)
+		all &= p[i];
+	return isl_sioimath_is_small(all);
+}
+
+/* Return 1 if "v" can be stored in small representation.
+ */
+static int fits_small(int64_t v)
+{
+	return ISL_SIOIMATH_SMALL_MIN <= v && v <= ISL_SIOIMATH_SMALL_MAX;
+}
+
+/* Store the "n" values in "r", which are known to fit in small
+ * representation, in "dst".  The elements of "dst" are known
+ * to be in small representation as well, so they do not need to be freed.
+ */
+static void store_small(isl_int *dst, int64_t *r, unsigned n)
+{
+	int i;
+
+	for (i = 0; i < n; ++i)
+		dst[i] = isl_sioimath_encode_small(r[i]);
+}
+
+/* Return the number of elements in the chunk starting at position "i"
+ * of a sequence of length "len".
+ */
+static unsigned chunk_len(unsigned i, unsigned len)
+{
+	if (len - i < ISL_SEQ_SMALL_CHUNK)
+		return len - i;
+	return ISL_SEQ_SMALL_CHUNK;
+}
+
+/* Compute dst = dst + f * src on "n" elements (at most
+ * ISL_SEQ_SMALL_CHUNK) in small representation using machine integers.
+ * The overflow status is only checked once for the entire chunk.
+ * Return 0 if some result does not fit in small representation,
+ * in which case "dst" is left untouched.
+ */
+static int addmul_small_chunk(isl_int *dst, isl_sioimath_small_t f,
+	isl_int *src, unsigned n)
+{
+	int i;
+	int ok = 1;
+	int64_t r[ISL_SEQ_SMALL_CHUNK];
+
+	for (i = 0; i < n; ++i) {
+		ok &= isl_sioimath_small_addmul(&r[i],
+			isl_sioimath_get_small(dst[i]), f,
+			isl_sioimath_get_small(src[i]));
+		ok &= fits_small(r[i]);
+	}
+	if (!ok)
+		return 0;
+	store_small(dst, r, n);
+	return 1;
+}
+
+/* Compute dst = dst - f * src on "n" elements (at most
+ * ISL_SEQ_SMALL_CHUNK) in small representation using machine integers.
+ * The overflow status is only checked once for the entire chunk.
+ * Return 0 if some result does not fit in small representation,
+ * in which case "dst" is left untouched.
+ */
+static int submul_small_chunk(isl_int *dst, isl_sioimath_small_t f,
+	isl_int *src, unsigned n)
+{
+	int i;
+	int ok = 1;
+	int64_t r[ISL_SEQ_SMALL_CHUNK];
+
+	for (i = 0; i < n; ++i) {
+		ok &= isl_sioimath_small_submul(&r[i],
+			isl_sioimath_get_small(dst[i]), f,
+			isl_sioimath_get_small(src[i]));
+		ok &= fits_small(r[i]);
+	}
+	if (!ok)
+		return 0;
+	store_small(dst, r, n);
+	return 1;
+}
+
+/* Compute dst = m1 * src1 + m2 * src2 on "n" elements (at most
+ * ISL_SEQ_SMALL_CHUNK) in small representation using machine integers.
+ * The overflow status is only checked once for the entire chunk.
+ * Return 0 if some result does not fit in small representation,
+ * in which case "dst" is left untouched.
+ */
+static int combine_small_chunk(isl_int *dst, isl_sioimath_small_t m1,
+	isl_int *src1, isl_sioimath_small_t m2, isl_int *src2, unsigned n)
+{
+	int i;
+	int ok = 1;
+	int64_t r[ISL_SEQ_SMALL_CHUNK];
+
+	for (i = 0; i < n; ++i) {
+		ok &= isl_sioimath_small_combine(&r[i],
+			m1, isl_sioimath_get_small(src1[i]),
+			m2, isl_sioimath_get_small(src2[i]));
+		ok &= fits_small(r[i]);
+	}
+	if (!ok)
+		return 0;
+	store_small(dst, r, n);
+	return 1;
+}
+
+/* Compute dst = dst + f * src using machine integers if "f" and
+ * all elements of "dst" and "src" are in small representation.
+ * Return 0 if this is not the case, in which case nothing is computed.
+ * Chunks in which some result does not fit in small representation
+ * are handled by isl_seq_addmul_generic.
+ */
+static int isl_seq_addmul_small(isl_int *dst, isl_int f, isl_int *src,
+	unsigned len)
+{
+	int i;
+	unsigned n;
+	isl_sioimath_small_t small;
+
+	if (!isl_sioimath_decode_small(f, &small))
+		return 0;
+	if (!isl_seq_is_small(dst, len) || !isl_seq_is_small(src, len))
+		return 0;
+
+	for (i = 0; i < len; i += n) {
+		n = chunk_len(i, len);
+		if (!addmul_small_chunk(dst + i, small, src + i, n))
+			isl_seq_addmul_generic(dst + i, f, src + i, n);
+	}
+
+	return 1;
+}
+
+/* Compute dst = dst - f * src using machine integers if "f" and
+ * all elements of "dst" and "src" are in small representation.
+ * Return 0 if this is not the case, in which case nothing is computed.
+ * Chunks in which some result does not fit in small representation
+ * are handled by isl_seq_submul_generic.
+ */
+static int isl_seq_submul_small(isl_int *dst, isl_int f, isl_int *src,
+	unsigned len)
+{
+	int i;
+	unsigned n;
+	isl_sioimath_small_t small;
+
+	if (!isl_sioimath_decode_small(f, &small))
+		return 0;
+	if (!isl_seq_is_small(dst, len) || !isl_seq_is_small(src, len))
+		return 0;
+
+	for (i = 0; i < len; i += n) {
+		n = chunk_len(i, len);
+		if (!submul_small_chunk(dst + i, small, src + i, n))
+			isl_seq_submul_generic(dst + i, f, src + i, n);
+	}
+
+	return 1;
+}
+
+/* Compute dst = m1 * src1 + m2 * src2 using machine integers if
+ * "m1", "m2" and all elements of "dst", "src1" and "src2" are
+ * in small representation.
+ * Return 0 if this is not the case, in which case nothing is computed.
+ * Chunks in which some result does not fit in small representation
+ * are handled by isl_seq_combine_generic.
+ */
+static int isl_seq_combine_small(isl_int *dst, isl_int m1, isl_int *src1,
+	isl_int m2, isl_int *src2, unsigned len)
+{
+	int i;
+	unsigned n;
+	isl_sioimath_small_t small1, small2;
+
+	if (!isl_sioimath_decode_small(m1, &small1) ||
+	    !isl_sioimath_decode_small(m2, &small2))
+		return 0;
+	if (!isl_seq_is_small(src1, len) || !isl_seq_is_small(src2, len))
+		return 0;
+	if (dst != src1 && dst != src2 && !isl_seq_is_small(dst, len))
+		return 0;
+
+	for (i = 0; i < len; i += n) {
+		n = chunk_len(i, len);
+		if (!combine_small_chunk(dst + i, small1, src1 + i,
+					small2, src2 + i, n))
+			isl_seq_combine_generic(dst + i, m1, src1 + i,
+						m2, src2 + i, n);
+	}
+
+	return 1;
+}
+
+/* Compute the gcd of the elements of "p" using machine integers
+ * if they are all in small representation.
+ * Return 0 if this is not the case, in which case nothing is computed.
+ */
+static int isl_seq_gcd_small(isl_int *p, unsigned len, isl_int *gcd)
+{
+	int i;
+	isl_sioimath_usmall_t g = 0;
+
+	if (!isl_seq_is_small(p, len))
+		return 0;
+
+	for (i = 0; g != 1 && i < len; ++i)
+		g = isl_sioimath_smallgcd(g, isl_sioimath_get_small(p[i]));
+	isl_sioimath_set_small(gcd, g);
+
+	return 1;
+}
+
+#else
+
+static int isl_seq_addmul_small(isl_int *dst, isl_int f, isl_int *src,
+	unsigned len)
+{
+	return 0;
+}
+
+static int isl_seq_submul_small(isl_int *dst, isl_int f, isl_int *src,
+	unsigned len)
+{
+	return 0;
+}
+
+static int isl_seq_combine_small(isl_int *dst, isl_int m1, isl_int *src1,
+	isl_int m2, isl_int *src2, unsigned len)
+{
+	return 0;
+}
+
+static int isl_seq_gcd_small(isl_int *p, unsigned len, isl_int *gcd)
+{
+	return 0;
+}
+
+#endif
+
+/* Restrict the sequence "src" of length "len" to the range
+ * of its non-zero elements, updating "dst" and "len" accordingly.
+ * Return 0 if "src" has no non-zero elements.
+ *
+ * Constraints in high-dimensional spaces, such as those of
+ * the coefficient spaces constructed by the scheduler,
+ * typically only involve a handful of the variables, so a row
+ * operation can often be restricted to a small part of the row.
+ */
+static int trim_to_non_zero(isl_int **dst, isl_int **src, unsigned *len)
+{
+	int first, last;
+
+	first = isl_seq_first_non_zero(*src, *len);
+	if (first < 0)
+		return 0;
+	last = isl_seq_last_non_zero(*src + first, *len - first);
+	*dst += first;
+	*src += first;
+	*len = last + 1;
+	return 1;
+}
+
+/* Compute dst = dst - f * src.
+ *
+ * Only the range of non-zero elements of "src" can affect "dst".
+ */
+void isl_seq_submul(isl_int *dst, isl_int f, isl_int *src, unsigned len)
+{
+	if (isl_int_is_zero(f) || !trim_to_non_zero(&dst, &src, &len))
+		return;
+	if (isl_seq_submul_small(dst, f, src, len))
+		return;
+	isl_seq_submul_generic(dst, f, src, len);
+}
+
+/* Compute dst = dst + f * src.
+ *
+ * Only the range of non-zero elements of "src" can affect "dst".
+ */
+void isl_seq_addmul(isl_int *dst, isl_int f, isl_int *src, unsigned len)
+{
+	if (isl_int_is_zero(f) || !trim_to_non_zero(&dst, &src, &len))
+		return;
+	if (isl_seq_addmul_small(dst, f, src, len))
+		return;
+	isl_seq_addmul_generic(dst, f, src, len);
+}
+
 void isl_seq_swp_or_cpy(isl_int *dst, isl_int *src, unsigned len)
 {
 	int i;
@@ -101,32 +437,51 @@ void isl_seq_fdiv_r(isl_int *dst, isl_int *src, isl_int m, unsigned len)
 		isl_int_fdiv_r(dst[i], src[i], m);
 }
 
+/* Compute dst = m1 * src1 + m2 * src2.
+ *
+ * If all inputs are in small representation (only possible if isl
+ * was configured with small integer optimization), then the rows
+ * are combined using machine integers.
+ */
 void isl_seq_combine(isl_int *dst, isl_int m1, isl_int *src1,
 			isl_int m2, isl_int *src2, unsigned len)
 {
-	int i;
-	isl_int tmp;
-
 	if (dst == src1 && isl_int_is_one(m1)) {
 		if (isl_int_is_zero(m2))
 			return;
-		for (i = 0; i < len; ++i)
-			isl_int_addmul(src1[i], m2, src2[i]);
+		isl_seq_addmul(src1, m2, src2, len);
 		return;
 	}
 
-	isl_int_init(tmp);
-	for (i = 0; i < len; ++i) {
-		isl_int_mul(tmp, m1, src1[i]);
-		isl_int_addmul(tmp, m2, src2[i]);
-		isl_int_set(dst[i], tmp);
-	}
-	isl_int_clear(tmp);
+	if (isl_seq_combine_small(dst, m1, src1, m2, src2, len))
+		return;
+	isl_seq_combine_generic(dst, m1, src1, m2, src2, len);
+}
+
+/* Replace "dst" by dst - s d src, with d = dst[pos] and s = src[pos],
+ * where "s" is known to be either 1 or -1.
+ * "d" is copied first since dst[pos] gets overwritten along the way.
+ */
+static void isl_seq_elim_unit(isl_int *dst, isl_int *src, unsigned pos,
+	unsigned len)
+{
+	isl_int d;
+
+	isl_int_init(d);
+	isl_int_set(d, dst[pos]);
+	if (isl_int_is_one(src[pos]))
+		isl_seq_submul(dst, d, src, len);
+	else
+		isl_seq_addmul(dst, d, src, len);
+	isl_int_clear(d);
 }
 
 /*
  * Let d = dst[pos] and s = src[pos]
  * dst is replaced by |s| dst - sgn(s)d src
+ *
+ * If |s| = 1, then there is no need to compute any gcd and
+ * "dst" (and "m") do not need to be scaled.
  */
 void isl_seq_elim(isl_int *dst, isl_int *src, unsigned pos, unsigned len,
 		  isl_int *m)
@@ -136,6 +491,10 @@ void isl_seq_elim(isl_int *dst, isl_int *src, unsigned pos, unsigned len,
 
 	if (isl_int_is_zero(dst[pos]))
 		return;
+	if (isl_int_is_one(src[pos]) || isl_int_is_negone(src[pos])) {
+		isl_seq_elim_unit(dst, src, pos, len);
+		return;
+	}
 
 	isl_int_init(a);
 	isl_int_init(b);
@@ -236,8 +595,12 @@ int isl_seq_abs_min_non_zero(isl_int *p, unsigned len)
 
 void isl_seq_gcd(isl_int *p, unsigned len, isl_int *gcd)
 {
-	int i, min = isl_seq_abs_min_non_zero(p, len);
+	int i, min;
+
+	if (isl_seq_gcd_small(p, len, gcd))
+		return;
 
+	min = isl_seq_abs_min_non_zero(p, len);
 	if (min < 0) {
 		isl_int_set_si(*gcd, 0);
 		return;
@@ -275,17 +638,20 @@ void isl_seq_lcm(isl_int *p, unsigned len, isl_int *lcm)
 		isl_int_lcm(*lcm, *lcm, p[i]);
 }
 
+/* Compute the inner product of "p1" and "p2", skipping the (typically
+ * many) pairs of elements where either of the two is zero.
+ */
 void isl_seq_inner_product(isl_int *p1, isl_int *p2, unsigned len,
 			   isl_int *prod)
 {
 	int i;
-	if (len == 0) {
-		isl_int_set_si(*prod, 0);
-		return;
-	}
-	isl_int_mul(*prod, p1[0], p2[0]);
-	for (i = 1; i < len; ++i)
+
+	isl_int_set_si(*prod, 0);
+	for (i = 0; i < len; ++i) {
+		if (isl_int_is_zero(p1[i]) || isl_int_is_zero(p2[i]))
+			continue;
 		isl_int_addmul(*prod, p1[i], p2[i]);
+	}
 }
 
 uint32_t isl_seq_hash(isl_int *p, unsigned len, uint32_t hash)
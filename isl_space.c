@@ -1832,6 +1832,36 @@ isl_bool isl_space_is_equal(__isl_keep isl_space *dim1,
 	       isl_space_tuple_is_equal(dim1, isl_dim_out, dim2, isl_dim_out);
 }
 
+/* Are the two spaces the same, including positions and names
+ * of all dimensions, also those inside nested tuples?
+ * isl_space_is_equal only takes into account the names
+ * of the parameters.
+ */
+isl_bool isl_space_has_equal_ids(__isl_keep isl_space *space1,
+	__isl_keep isl_space *space2)
+{
+	int i;
+	isl_bool equal;
+
+	equal = isl_space_is_equal(space1, space2);
+	if (equal < 0 || !equal)
+		return equal;
+	if (space1 == space2)
+		return isl_bool_true;
+	if (!match(space1, isl_dim_in, space2, isl_dim_in) ||
+	    !match(space1, isl_dim_out, space2, isl_dim_out))
+		return isl_bool_false;
+	for (i = 0; i < 2; ++i) {
+		if (!space1->nested[i])
+			continue;
+		equal = isl_space_has_equal_ids(space1->nested[i],
+						space2->nested[i]);
+		if (equal < 0 || !equal)
+			return equal;
+	}
+	return isl_bool_true;
+}
+
 /* Is space1 equal to the domain of space2?
  *
  * In the internal version we also allow space2 to be the space of a set,
@@ -29,6 +29,8 @@ __isl_give isl_space *isl_space_underlying(__isl_take isl_space *dim,
 
 uint32_t isl_space_get_hash(__isl_keep isl_space *dim);
 
+isl_bool isl_space_has_equal_ids(__isl_keep isl_space *space1,
+	__isl_keep isl_space *space2);
 isl_bool isl_space_is_domain_internal(__isl_keep isl_space *space1,
 	__isl_keep isl_space *space2);
 isl_bool isl_space_is_range_internal(__isl_keep isl_space *space1,
@@ -1104,6 +1104,14 @@ static void update_row_sign(struct isl_tab *tab, int row, int col, int row_sgn)
  * s(n_rc)d_r/|n_rc|		-s(n_rc)n_ri/|n_rc|
  * s(n_rc)d_r n_jc/(|n_rc| d_j)	(n_ji |n_rc| - s(n_rc)n_jc n_ri)/(|n_rc| d_j)
  *
+ * The update of each row j is performed using a single call
+ * to isl_seq_combine on the entire row, with n_jc saved in "f",
+ * after which the entry in the pivot column is fixed up.
+ * If isl was configured with small integer optimization,
+ * then this update is performed directly on machine integers
+ * as long as all entries involved are small and is transparently
+ * redone on the full integer representation for any chunk
+ * where an overflow is detected.
  */
 int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 {
@@ -1114,11 +1122,14 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 	struct isl_mat *mat = tab->mat;
 	struct isl_tab_var *var;
 	unsigned off = 2 + tab->M;
+	isl_int f;
 
 	ctx = isl_tab_get_ctx(tab);
 	if (isl_ctx_next_operation(ctx) < 0)
 		return -1;
+	ctx->stats->tab_pivots++;
 
+	isl_int_init(f);
 	isl_int_swap(mat->row[row][0], mat->row[row][off + col]);
 	sgn = isl_int_sgn(mat->row[row][0]);
 	if (sgn < 0) {
@@ -1138,19 +1149,15 @@ int isl_tab_pivot(struct isl_tab *tab, int row, int col)
 		if (isl_int_is_zero(mat->row[i][off + col]))
 			continue;
 		isl_int_mul(mat->row[i][0], mat->row[i][0], mat->row[row][0]);
-		for (j = 0; j < off - 1 + tab->n_col; ++j) {
-			if (j == off - 1 + col)
-				continue;
-			isl_int_mul(mat->row[i][1 + j],
-				    mat->row[i][1 + j], mat->row[row][0]);
-			isl_int_addmul(mat->row[i][1 + j],
-				    mat->row[i][off + col], mat->row[row][1 + j]);
-		}
-		isl_int_mul(mat->row[i][off + col],
-			    mat->row[i][off + col], mat->row[row][off + col]);
+		isl_int_set(f, mat->row[i][off + col]);
+		isl_seq_combine(mat->row[i] + 1, mat->row[row][0],
+				mat->row[i] + 1, f,
+				mat->row[row] + 1, off - 1 + tab->n_col);
+		isl_int_mul(mat->row[i][off + col], f, mat->row[row][off + col]);
 		if (!isl_int_is_one(mat->row[i][0]))
 			isl_seq_normalize(mat->ctx, mat->row[i], off + tab->n_col);
 	}
+	isl_int_clear(f);
 	t = tab->row_var[row];
 	tab->row_var[row] = tab->col_var[col];
 	tab->col_var[col] = t;
@@ -258,7 +258,7 @@ struct isl_region {
 };
 
 __isl_give isl_vec *isl_tab_basic_set_non_trivial_lexmin(
-	__isl_take isl_basic_set *bset, int n_op, int n_region,
+	__isl_take isl_basic_set *bset, int n_op, int max_zero, int n_region,
 	struct isl_region *region,
 	int (*conflict)(int con, void *user), void *user);
 __isl_give isl_vec *isl_tab_basic_set_non_neg_lexmin(
@@ -19,6 +19,8 @@
 #include <isl_vec_private.h>
 #include <isl_aff_private.h>
 #include <isl_options_private.h>
+#include <isl_space_private.h>
+#include <isl_morph.h>
 #include <isl_config.h>
 
 /*
@@ -1585,23 +1587,6 @@ static int next_non_integer_var(struct isl_tab *tab, int var, int *f)
 	return -1;
 }
 
-/* Check for first (non-parameter) variable that is non-integer and
- * therefore requires a cut and return the corresponding row.
- * For parametric tableaus, there are three parts in a row,
- * the constant, the coefficients of the parameters and the rest.
- * For each part, we check whether the coefficients in that part
- * are all integral and if so, set the corresponding flag in *f.
- * If the constant and the parameter part are integral, then the
- * current sample value is integral and no cut is required
- * (irrespective of whether the variable part is integral).
- */
-static int first_non_integer_row(struct isl_tab *tab, int *f)
-{
-	int var = next_non_integer_var(tab, -1, f);
-
-	return var < 0 ? -1 : tab->var[var].index;
-}
-
 /* Add a (non-parametric) cut to cut away the non-integral sample
  * value of the given row.
  *
@@ -1657,6 +1642,40 @@ static int add_cut(struct isl_tab *tab, int row)
 	return tab->con[r].index;
 }
 
+/* Add a cut for the non-integral sample value of variable "var",
+ * which has integral coefficients for the parameters,
+ * and for all later variables with a non-integral sample value
+ * that also have integral coefficients for the parameters.
+ * If any of these later variables has integral coefficients
+ * for all other columns too, then it cannot attain an integral value and
+ * the tableau is marked empty.
+ * Variables with non-integral coefficients for the parameters
+ * require an update of the context tableau and are left to the caller.
+ *
+ * Adding all these cuts in one go, rather than a single cut
+ * per iteration of find_solutions, avoids recomputing the signs
+ * of all rows in between and allows restore_lexmin to resolve
+ * all violated cuts together.
+ *
+ * Return 0 on success and -1 on error.
+ */
+static int add_non_parametric_cuts(struct isl_tab *tab, int var)
+{
+	int flags;
+
+	do {
+		if (add_cut(tab, tab->var[var].index) < 0)
+			return -1;
+		do {
+			var = next_non_integer_var(tab, var, &flags);
+		} while (var >= 0 && !ISL_FL_ISSET(flags, I_PAR));
+		if (var >= 0 && ISL_FL_ISSET(flags, I_VAR))
+			return isl_tab_mark_empty(tab);
+	} while (var >= 0);
+
+	return 0;
+}
+
 #define CUT_ALL 1
 #define CUT_ONE 0
 
@@ -2135,6 +2154,19 @@ error:
 	return NULL;
 }
 
+/* Free the array "ineq" of "n" (possibly NULL) parametric inequalities.
+ */
+static void free_row_parameter_ineqs(struct isl_vec **ineq, int n)
+{
+	int i;
+
+	if (!ineq)
+		return;
+	for (i = 0; i < n; ++i)
+		isl_vec_free(ineq[i]);
+	free(ineq);
+}
+
 /* Given a main tableau where more than one row requires a split,
  * determine and return the "best" row to split on.
  *
@@ -2157,38 +2189,50 @@ error:
  * to some arbitrary value (0) anyway.  Without this redundant initialization
  * valgrind may warn about uninitialized memory accesses when isl
  * is compiled with some versions of gcc.
+ *
+ * The parametric inequalities of the candidate rows are computed
+ * only once and stored in "ineq", indexed by row.
+ * If a row makes all other candidate rows redundant, then no other row
+ * can be better and the search is stopped.
  */
 static int best_split(struct isl_tab *tab, struct isl_tab *context_tab)
 {
 	struct isl_tab_undo *snap;
+	struct isl_vec **ineq;
 	int split;
 	int row;
+	int n_any = 0;
 	int best = -1;
 	int best_r = 0;
 
 	if (isl_tab_extend_cons(context_tab, 2) < 0)
 		return -1;
 
+	ineq = isl_calloc_array(tab->mat->ctx, struct isl_vec *, tab->n_row);
+	if (tab->n_row && !ineq)
+		return -1;
+	for (row = tab->n_redundant; row < tab->n_row; ++row) {
+		if (!isl_tab_var_from_row(tab, row)->is_nonneg)
+			continue;
+		if (tab->row_sign[row] != isl_tab_row_any)
+			continue;
+		ineq[row] = get_row_parameter_ineq(tab, row);
+		if (!ineq[row])
+			goto error;
+		n_any++;
+	}
+
 	snap = isl_tab_snap(context_tab);
 
 	for (split = tab->n_redundant; split < tab->n_row; ++split) {
 		struct isl_tab_undo *snap2;
-		struct isl_vec *ineq = NULL;
 		int r = 0;
-		int ok;
 
-		if (!isl_tab_var_from_row(tab, split)->is_nonneg)
-			continue;
-		if (tab->row_sign[split] != isl_tab_row_any)
+		if (!ineq[split])
 			continue;
 
-		ineq = get_row_parameter_ineq(tab, split);
-		if (!ineq)
-			return -1;
-		ok = isl_tab_add_ineq(context_tab, ineq->el) >= 0;
-		isl_vec_free(ineq);
-		if (!ok)
-			return -1;
+		if (isl_tab_add_ineq(context_tab, ineq[split]->el) < 0)
+			goto error;
 
 		snap2 = isl_tab_snap(context_tab);
 
@@ -2197,34 +2241,33 @@ static int best_split(struct isl_tab *tab, struct isl_tab *context_tab)
 
 			if (row == split)
 				continue;
-			if (!isl_tab_var_from_row(tab, row)->is_nonneg)
-				continue;
-			if (tab->row_sign[row] != isl_tab_row_any)
+			if (!ineq[row])
 				continue;
 
-			ineq = get_row_parameter_ineq(tab, row);
-			if (!ineq)
-				return -1;
-			ok = isl_tab_add_ineq(context_tab, ineq->el) >= 0;
-			isl_vec_free(ineq);
-			if (!ok)
-				return -1;
+			if (isl_tab_add_ineq(context_tab, ineq[row]->el) < 0)
+				goto error;
 			var = &context_tab->con[context_tab->n_con - 1];
 			if (!context_tab->empty &&
 			    !isl_tab_min_at_most_neg_one(context_tab, var))
 				r++;
 			if (isl_tab_rollback(context_tab, snap2) < 0)
-				return -1;
+				goto error;
 		}
 		if (best == -1 || r > best_r) {
 			best = split;
 			best_r = r;
 		}
 		if (isl_tab_rollback(context_tab, snap) < 0)
-			return -1;
+			goto error;
+		if (best_r == n_any - 1)
+			break;
 	}
 
+	free_row_parameter_ineqs(ineq, tab->n_row);
 	return best;
+error:
+	free_row_parameter_ineqs(ineq, tab->n_row);
+	return -1;
 }
 
 static struct isl_basic_set *context_lex_peek_basic_set(
@@ -3751,6 +3794,8 @@ error:
  * If, on the other hand, one or more of the other columns have rational
  * coefficients, but the parameter coefficients are all integral, then
  * we can perform a regular (non-parametric) cut.
+ * In this case, regular cuts are also added for all later variables
+ * that allow them, before restore_lexmin is called.
  * Finally, if there is any parameter coefficient that is non-integral,
  * then we need to involve the context tableau.  There are two cases here.
  * If at least one other column has a rational coefficient, then we
@@ -3787,6 +3832,7 @@ static void find_solutions(struct isl_sol *sol, struct isl_tab *tab)
 	for (r = 0; r >= 0 && tab && !tab->empty; r = restore_lexmin(tab)) {
 		int flags;
 		int row;
+		int var;
 		enum isl_tab_row_sign sgn;
 		int split = -1;
 		int n_split = 0;
@@ -3838,16 +3884,17 @@ static void find_solutions(struct isl_sol *sol, struct isl_tab *tab)
 		}
 		if (tab->rational)
 			break;
-		row = first_non_integer_row(tab, &flags);
-		if (row < 0)
+		var = next_non_integer_var(tab, -1, &flags);
+		if (var < 0)
 			break;
+		row = tab->var[var].index;
 		if (ISL_FL_ISSET(flags, I_PAR)) {
 			if (ISL_FL_ISSET(flags, I_VAR)) {
 				if (isl_tab_mark_empty(tab) < 0)
 					goto error;
 				break;
 			}
-			row = add_cut(tab, row);
+			row = add_non_parametric_cuts(tab, var);
 		} else if (ISL_FL_ISSET(flags, I_VAR)) {
 			struct isl_vec *div;
 			struct isl_vec *ineq;
@@ -4699,6 +4746,424 @@ error:
 	return NULL;
 }
 
+/* Free the entries in the cache of results of parametric
+ * lexicographic optimization of "ctx".
+ */
+void isl_ctx_clear_lexopt_cache(isl_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ctx->n_lexopt_cache; ++i) {
+		struct isl_lexopt_cache_entry *entry = &ctx->lexopt_cache[i];
+
+		isl_basic_map_free(entry->bmap);
+		isl_basic_set_free(entry->dom);
+		isl_map_free(entry->map);
+		isl_pw_multi_aff_free(entry->pma);
+		isl_set_free(entry->empty);
+	}
+	free(ctx->lexopt_cache);
+	ctx->lexopt_cache = NULL;
+	ctx->n_lexopt_cache = 0;
+}
+
+/* Does "entry" hold the result of computing the lexicographic
+ * minimum (or maximum if "max" is set) of "bmap" over "dom"
+ * in the form requested by "pma" and including the part of "dom"
+ * without solutions if "want_empty" is set?
+ * "bmap" and "dom" are assumed to have been normalized and
+ * "hash" to be the combination of their hash values.
+ * The spaces are compared separately since isl_basic_map_plain_is_equal
+ * only compares the constraints.  This includes the names
+ * of all dimensions since the cached result has the names
+ * of the cached "bmap" and "dom".
+ */
+static isl_bool lexopt_cache_entry_matches(struct isl_lexopt_cache_entry *entry,
+	uint32_t hash, __isl_keep isl_basic_map *bmap,
+	__isl_keep isl_basic_set *dom, int max, int pma, int want_empty)
+{
+	isl_bool equal;
+
+	if (entry->hash != hash || entry->max != max)
+		return isl_bool_false;
+	if (pma != !!entry->pma)
+		return isl_bool_false;
+	if (want_empty && !entry->empty)
+		return isl_bool_false;
+	equal = isl_space_has_equal_ids(entry->bmap->dim, bmap->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	equal = isl_space_has_equal_ids(entry->dom->dim, dom->dim);
+	if (equal < 0 || !equal)
+		return equal;
+	equal = isl_basic_map_plain_is_equal(entry->bmap, bmap);
+	if (equal < 0 || !equal)
+		return equal;
+	return isl_basic_set_plain_is_equal(entry->dom, dom);
+}
+
+/* Look for an entry in the lexopt cache of "ctx" that holds
+ * the lexicographic minimum (or maximum if "max" is set) of "bmap"
+ * over "dom" in the form requested by "pma".
+ * If there is such an entry, then return an unshared copy of the result
+ * in "res" (and of the part of "dom" without solutions in "empty"
+ * if "empty" is not NULL) and move the entry to the front of the cache.
+ * The entries in the cache are kept in order of most recent use.
+ * The cached result is not handed out directly since some callers
+ * modify the result in place, assuming that they hold
+ * the only reference to it.
+ */
+static isl_bool lexopt_cache_find(isl_ctx *ctx, uint32_t hash,
+	__isl_keep isl_basic_map *bmap, __isl_keep isl_basic_set *dom,
+	int max, int pma, union isl_lex_res *res, __isl_give isl_set **empty)
+{
+	int i, j;
+	isl_bool match;
+	struct isl_lexopt_cache_entry entry;
+
+	for (i = 0; i < ctx->n_lexopt_cache; ++i) {
+		match = lexopt_cache_entry_matches(&ctx->lexopt_cache[i],
+					hash, bmap, dom, max, pma, !!empty);
+		if (match < 0)
+			return isl_bool_error;
+		if (match)
+			break;
+	}
+	if (i >= ctx->n_lexopt_cache)
+		return isl_bool_false;
+
+	entry = ctx->lexopt_cache[i];
+	for (j = i; j > 0; --j)
+		ctx->lexopt_cache[j] = ctx->lexopt_cache[j - 1];
+	ctx->lexopt_cache[0] = entry;
+
+	if (pma)
+		res->pma = isl_pw_multi_aff_dup(entry.pma);
+	else
+		res->map = isl_map_dup(entry.map);
+	if (empty)
+		*empty = isl_set_dup(entry.empty);
+	if (!res->p || (empty && !*empty))
+		return isl_bool_error;
+	return isl_bool_true;
+}
+
+/* Add an entry to the front of the lexopt cache of "ctx" recording
+ * that "res" (in the form specified by "pma") is the lexicographic
+ * minimum (or maximum if "max" is set) of "bmap" over "dom" and
+ * that "empty" (if not NULL) is the part of "dom" without solutions,
+ * where "hash" combines the hash values of "bmap" and "dom".
+ * The cache keeps its own unshared copies of "res" and "empty".
+ * If the cache is full, then the least recently used entries
+ * are removed first.
+ */
+static isl_stat lexopt_cache_add(isl_ctx *ctx, uint32_t hash,
+	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
+	int max, int pma, union isl_lex_res res, __isl_keep isl_set *empty)
+{
+	int i, n;
+	struct isl_lexopt_cache_entry *cache;
+
+	if (!bmap || !dom || !res.p)
+		goto error;
+
+	n = ctx->opt->lexopt_cache_size;
+	while (ctx->n_lexopt_cache > 0 && ctx->n_lexopt_cache >= n) {
+		struct isl_lexopt_cache_entry *entry;
+
+		entry = &ctx->lexopt_cache[--ctx->n_lexopt_cache];
+		isl_basic_map_free(entry->bmap);
+		isl_basic_set_free(entry->dom);
+		isl_map_free(entry->map);
+		isl_pw_multi_aff_free(entry->pma);
+		isl_set_free(entry->empty);
+	}
+
+	cache = isl_realloc_array(ctx, ctx->lexopt_cache,
+		    struct isl_lexopt_cache_entry, ctx->n_lexopt_cache + 1);
+	if (!cache)
+		goto error;
+	ctx->lexopt_cache = cache;
+	for (i = ctx->n_lexopt_cache; i > 0; --i)
+		cache[i] = cache[i - 1];
+	cache[0].hash = hash;
+	cache[0].max = max;
+	cache[0].bmap = bmap;
+	cache[0].dom = dom;
+	cache[0].map = pma ? NULL : isl_map_dup(res.map);
+	cache[0].pma = pma ? isl_pw_multi_aff_dup(res.pma) : NULL;
+	cache[0].empty = empty ? isl_set_dup(empty) : NULL;
+	ctx->n_lexopt_cache++;
+
+	return isl_stat_ok;
+error:
+	isl_basic_map_free(bmap);
+	isl_basic_set_free(dom);
+	return isl_stat_error;
+}
+
+/* Compute the lexicographic minimum (or maximum if "max" is set)
+ * of "bmap" over the domain "dom" using "compute", in the form
+ * specified by "pma", reusing a previously computed result
+ * from the lexopt cache if the same problem was solved before.
+ *
+ * The cache is keyed on normalized copies of "bmap" and "dom",
+ * while "compute" is applied to the original inputs.
+ * Note that on a cache hit, the result is a copy of the result
+ * computed for an earlier input with the same normalized form,
+ * which may therefore have a different (but equivalent) representation
+ * from the one that would be computed for "bmap" and "dom".
+ * If "empty" is not NULL, then only cache entries that also
+ * hold the part of "dom" without solutions can be reused.
+ */
+static union isl_lex_res basic_map_partial_lexopt_cached(
+	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
+	__isl_give isl_set **empty, int max, int pma,
+	union isl_lex_res (*compute)(__isl_take isl_basic_map *bmap,
+		__isl_take isl_basic_set *dom, __isl_give isl_set **empty,
+		int max))
+{
+	isl_ctx *ctx;
+	uint32_t hash;
+	isl_bool found;
+	isl_basic_map *key_bmap;
+	isl_basic_set *key_dom;
+	union isl_lex_res res = { NULL };
+
+	if (!bmap || !dom)
+		return compute(bmap, dom, empty, max);
+
+	ctx = isl_basic_map_get_ctx(bmap);
+	key_bmap = isl_basic_map_normalize(isl_basic_map_copy(bmap));
+	key_dom = isl_basic_set_copy(dom);
+	key_dom = (isl_basic_set *)
+		isl_basic_map_normalize((isl_basic_map *)key_dom);
+	if (!key_bmap || !key_dom)
+		goto error;
+
+	hash = isl_hash_init();
+	isl_hash_hash(hash, isl_basic_map_get_hash(key_bmap));
+	isl_hash_hash(hash, isl_basic_map_get_hash((isl_basic_map *)key_dom));
+	found = lexopt_cache_find(ctx, hash, key_bmap, key_dom, max, pma,
+				    &res, empty);
+	if (found < 0)
+		goto error;
+	if (found) {
+		ctx->stats->lexopt_cache_hits++;
+		isl_basic_map_free(key_bmap);
+		isl_basic_set_free(key_dom);
+		isl_basic_map_free(bmap);
+		isl_basic_set_free(dom);
+		return res;
+	}
+
+	ctx->stats->lexopt_cache_misses++;
+	res = compute(bmap, dom, empty, max);
+	if (lexopt_cache_add(ctx, hash, key_bmap, key_dom, max, pma, res,
+				empty ? *empty : NULL) < 0)
+		goto error_res;
+	return res;
+error:
+	isl_basic_map_free(key_bmap);
+	isl_basic_set_free(key_dom);
+	isl_basic_map_free(bmap);
+	isl_basic_set_free(dom);
+	if (empty)
+		*empty = NULL;
+	return res;
+error_res:
+	if (pma)
+		isl_pw_multi_aff_free(res.pma);
+	else
+		isl_map_free(res.map);
+	if (empty)
+		*empty = isl_set_free(*empty);
+	res.p = NULL;
+	return res;
+}
+
+/* Free the compression of the domain of a PIP problem
+ * that is kept in "ctx" for reuse.
+ */
+void isl_ctx_clear_pip_compression(isl_ctx *ctx)
+{
+	ctx->pip_compression_dom = isl_basic_set_free(ctx->pip_compression_dom);
+	isl_morph_free(ctx->pip_compression);
+	ctx->pip_compression = NULL;
+}
+
+/* Does "dom" have equality constraints that involve the set variables?
+ */
+static isl_bool has_set_var_equalities(__isl_keep isl_basic_set *dom)
+{
+	int i;
+	unsigned nparam, dim;
+
+	if (!dom)
+		return isl_bool_error;
+
+	nparam = isl_basic_set_dim(dom, isl_dim_param);
+	dim = isl_basic_set_dim(dom, isl_dim_set);
+	for (i = 0; i < dom->n_eq; ++i)
+		if (isl_seq_first_non_zero(dom->eq[i] + 1 + nparam, dim) != -1)
+			return isl_bool_true;
+	return isl_bool_false;
+}
+
+/* Return a compression of the set variables of "dom"
+ * with respect to the equality constraints of "dom".
+ *
+ * The same domain is typically used for several PIP problems
+ * in a row, so the most recently computed compression is kept
+ * in the isl_ctx and reused if it was computed for the same domain,
+ * including the names of the dimensions, since these names
+ * also appear in the spaces of the compression.
+ * isl_basic_set_variable_compression requires its input to have been
+ * gaussed, so the compression is computed on a gaussed duplicate
+ * of "dom" such that "dom" itself is not modified.
+ */
+static __isl_give isl_morph *domain_compression(__isl_keep isl_basic_set *dom)
+{
+	isl_ctx *ctx;
+	isl_bool equal;
+	isl_morph *morph;
+	isl_basic_set *copy;
+
+	ctx = isl_basic_set_get_ctx(dom);
+	equal = isl_bool_false;
+	if (ctx->pip_compression_dom == dom)
+		equal = isl_bool_true;
+	else if (ctx->pip_compression_dom)
+		equal = isl_space_has_equal_ids(ctx->pip_compression_dom->dim,
+						dom->dim);
+	if (equal > 0 && ctx->pip_compression_dom != dom)
+		equal = isl_basic_set_plain_is_equal(ctx->pip_compression_dom,
+						    dom);
+	if (equal < 0)
+		return NULL;
+	if (equal) {
+		ctx->stats->pip_compression_hits++;
+		return isl_morph_copy(ctx->pip_compression);
+	}
+
+	ctx->stats->pip_compression_misses++;
+	copy = isl_basic_set_gauss(isl_basic_set_dup(dom), NULL);
+	morph = isl_basic_set_variable_compression(copy, isl_dim_set);
+	isl_basic_set_free(copy);
+
+	isl_ctx_clear_pip_compression(ctx);
+	if (morph) {
+		ctx->pip_compression_dom = isl_basic_set_copy(dom);
+		ctx->pip_compression = isl_morph_copy(morph);
+	}
+
+	return morph;
+}
+
+/* Should the domain variables of a PIP problem over the domain "dom"
+ * be compressed before the problem is solved?
+ * If so, return the compression in "morph".
+ *
+ * This is the case if the pip-compress option is set and
+ * if "dom" has equality constraints that involve the domain variables.
+ * Since isl_basic_set_variable_compression cannot handle existentially
+ * quantified variables, no compression is performed if "dom" has any.
+ * Rational problems are left alone as well.
+ * If the inverse of the compression is not integral, then
+ * the substitution would need to be accompanied by stride constraints
+ * on the parameters.  This case is not considered worth the effort.
+ * Finally, if "dom" turns out not to have any integer points,
+ * then there is nothing to compress.
+ */
+static isl_bool get_domain_compression(__isl_keep isl_basic_set *dom,
+	__isl_give isl_morph **morph)
+{
+	isl_bool compress;
+
+	*morph = NULL;
+	if (!dom)
+		return isl_bool_error;
+	if (!dom->ctx->opt->pip_compress)
+		return isl_bool_false;
+	if (dom->n_eq == 0 || dom->n_div != 0)
+		return isl_bool_false;
+	if (ISL_F_ISSET(dom, ISL_BASIC_SET_RATIONAL))
+		return isl_bool_false;
+	compress = has_set_var_equalities(dom);
+	if (compress < 0 || !compress)
+		return compress;
+
+	*morph = domain_compression(dom);
+	if (!*morph)
+		return isl_bool_error;
+	if (isl_int_is_one((*morph)->inv->row[0][0]) &&
+	    !isl_basic_set_plain_is_empty((*morph)->ran))
+		return isl_bool_true;
+	isl_morph_free(*morph);
+	*morph = NULL;
+	return isl_bool_false;
+}
+
+/* Compute the lexicographic minimum (or maximum if "max" is set)
+ * of "bmap" over the domain "dom" using "compute", in the form
+ * specified by "pma", after compressing the domain variables
+ * using "morph", a compression of the set variables of "dom"
+ * with respect to its equality constraints with an integral inverse.
+ *
+ * Let "morph" map x to x' = Q x with inverse x = C(p, x').
+ * The PIP problem is solved over the compressed domain
+ * with the domain variables of "bmap" replaced by C(p, x').
+ * The result (and the part of the domain without solutions)
+ * is then expressed in terms of x again by plugging in Q x and
+ * intersecting the domain with the equality constraints of "dom"
+ * that were used in the compression, i.e., the domain of "morph".
+ * The inequality constraints of "dom" are already taken into account
+ * by the compressed problem.
+ */
+static union isl_lex_res basic_map_partial_lexopt_compressed(
+	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
+	__isl_take isl_morph *morph, __isl_give isl_set **empty,
+	int max, int pma,
+	union isl_lex_res (*compute)(__isl_take isl_basic_map *bmap,
+		__isl_take isl_basic_set *dom, __isl_give isl_set **empty,
+		int max))
+{
+	isl_morph *inv;
+	isl_multi_aff *ma;
+	isl_set *eq;
+	union isl_lex_res res;
+
+	inv = isl_morph_inverse(isl_morph_copy(morph));
+	ma = isl_morph_get_var_multi_aff(inv);
+	isl_morph_free(inv);
+	bmap = isl_basic_map_preimage_domain_multi_aff(bmap, ma);
+	dom = isl_morph_basic_set(isl_morph_copy(morph), dom);
+	res = compute(bmap, dom, empty, max);
+
+	ma = isl_morph_get_var_multi_aff(morph);
+	eq = isl_set_from_basic_set(isl_basic_set_copy(morph->dom));
+	isl_morph_free(morph);
+	if (pma) {
+		res.pma = isl_pw_multi_aff_pullback_multi_aff(res.pma,
+						    isl_multi_aff_copy(ma));
+		res.pma = isl_pw_multi_aff_intersect_domain(res.pma,
+						    isl_set_copy(eq));
+	} else {
+		res.map = isl_map_preimage_domain_multi_aff(res.map,
+						    isl_multi_aff_copy(ma));
+		res.map = isl_map_intersect_domain(res.map, isl_set_copy(eq));
+	}
+	if (empty && *empty) {
+		*empty = isl_set_preimage_multi_aff(*empty,
+						    isl_multi_aff_copy(ma));
+		*empty = isl_set_intersect(*empty, isl_set_copy(eq));
+	}
+	isl_multi_aff_free(ma);
+	isl_set_free(eq);
+
+	return res;
+}
+
 /* Compute the lexicographic minimum (or maximum if "max" is set)
  * of "bmap" over the domain "dom" and return the result as a map.
  * If "empty" is not NULL, then *empty is assigned a set that
@@ -4717,10 +5182,14 @@ error:
  * for symmetries on the constraints, before we set up the main tableau.
  * It is then no good to look for symmetries on possibly redundant constraints.
  */
-struct isl_map *isl_tab_basic_map_partial_lexopt(
-		struct isl_basic_map *bmap, struct isl_basic_set *dom,
-		struct isl_set **empty, int max)
+static union isl_lex_res tab_basic_map_partial_lexopt(
+	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
+	__isl_give isl_set **empty, int max)
 {
+	isl_bool compress;
+	isl_morph *morph;
+	union isl_lex_res res = { NULL };
+
 	if (empty)
 		*empty = NULL;
 	if (!bmap || !dom)
@@ -4729,18 +5198,43 @@ struct isl_map *isl_tab_basic_map_partial_lexopt(
 	isl_assert(bmap->ctx,
 	    isl_basic_map_compatible_domain(bmap, dom), goto error);
 
-	if (isl_basic_set_dim(dom, isl_dim_all) == 0)
-		return basic_map_partial_lexopt(bmap, dom, empty, max);
+	if (isl_basic_set_dim(dom, isl_dim_all) == 0) {
+		res.map = basic_map_partial_lexopt(bmap, dom, empty, max);
+		return res;
+	}
+
+	compress = get_domain_compression(dom, &morph);
+	if (compress < 0)
+		goto error;
+	if (compress)
+		return basic_map_partial_lexopt_compressed(bmap, dom, morph,
+			    empty, max, 0, &tab_basic_map_partial_lexopt);
 
 	bmap = isl_basic_map_intersect_domain(bmap, isl_basic_set_copy(dom));
 	bmap = isl_basic_map_detect_equalities(bmap);
 	bmap = isl_basic_map_remove_redundancies(bmap);
 
-	return basic_map_partial_lexopt(bmap, dom, empty, max);
+	res.map = basic_map_partial_lexopt(bmap, dom, empty, max);
+	return res;
 error:
 	isl_basic_set_free(dom);
 	isl_basic_map_free(bmap);
-	return NULL;
+	return res;
+}
+
+/* Compute the lexicographic minimum (or maximum if "max" is set)
+ * of "bmap" over the domain "dom" and return the result as a map.
+ * If the lexopt-cache-size option is positive, then the result
+ * is looked up in and stored in the lexopt cache.
+ */
+struct isl_map *isl_tab_basic_map_partial_lexopt(
+		struct isl_basic_map *bmap, struct isl_basic_set *dom,
+		struct isl_set **empty, int max)
+{
+	if (bmap && bmap->ctx->opt->lexopt_cache_size > 0)
+		return basic_map_partial_lexopt_cached(bmap, dom, empty, max,
+				0, &tab_basic_map_partial_lexopt).map;
+	return tab_basic_map_partial_lexopt(bmap, dom, empty, max).map;
 }
 
 struct isl_sol_for {
@@ -4969,13 +5463,14 @@ static int first_trivial_region(struct isl_tab *tab,
 }
 
 /* Check if the solution is optimal, i.e., whether the first
- * n_op entries are zero.
+ * n_zero entries are zero, where n_zero is the maximal number
+ * of initial zeros that can be attained.
  */
-static int is_optimal(__isl_keep isl_vec *sol, int n_op)
+static int is_optimal(__isl_keep isl_vec *sol, int n_zero)
 {
 	int i;
 
-	for (i = 0; i < n_op; ++i)
+	for (i = 0; i < n_zero; ++i)
 		if (!isl_int_is_zero(sol->el[1 + i]))
 			return 0;
 	return 1;
@@ -5044,6 +5539,11 @@ struct isl_trivial {
  * for solution that result in significantly better values for those
  * initial coordinates.  That is, we only continue looking for solutions
  * that increase the number of initial zeros in this sequence.
+ * "max_zero" is an upper bound on the number of initial zeros
+ * in this sequence that can be attained by any solution.
+ * If the caller has no further information, it is equal to n_op.
+ * As soon as a solution is found that attains this bound,
+ * no significantly better solution can exist and the search is stopped.
  *
  * A solution is non-trivial, if it is non-trivial on each of the
  * specified regions.  Each region represents a sequence of pairs
@@ -5073,7 +5573,7 @@ struct isl_trivial {
  *	x_0_b - x_0_a >= 1
  */
 __isl_give isl_vec *isl_tab_basic_set_non_trivial_lexmin(
-	__isl_take isl_basic_set *bset, int n_op, int n_region,
+	__isl_take isl_basic_set *bset, int n_op, int max_zero, int n_region,
 	struct isl_region *region,
 	int (*conflict)(int con, void *user), void *user)
 {
@@ -5123,7 +5623,7 @@ __isl_give isl_vec *isl_tab_basic_set_non_trivial_lexmin(
 				sol = isl_tab_get_sample_value(tab);
 				if (!sol)
 					goto error;
-				if (is_optimal(sol, n_op))
+				if (is_optimal(sol, max_zero))
 					break;
 				goto backtrack;
 			}
@@ -5642,10 +6142,14 @@ error:
  * for symmetries on the constraints, before we set up the main tableau.
  * It is then no good to look for symmetries on possibly redundant constraints.
  */
-__isl_give isl_pw_multi_aff *isl_basic_map_partial_lexopt_pw_multi_aff(
+static union isl_lex_res basic_map_partial_lexopt_pw_multi_aff(
 	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
 	__isl_give isl_set **empty, int max)
 {
+	isl_bool compress;
+	isl_morph *morph;
+	union isl_lex_res res = { NULL };
+
 	if (empty)
 		*empty = NULL;
 	if (!bmap || !dom)
@@ -5654,16 +6158,43 @@ __isl_give isl_pw_multi_aff *isl_basic_map_partial_lexopt_pw_multi_aff(
 	isl_assert(bmap->ctx,
 	    isl_basic_map_compatible_domain(bmap, dom), goto error);
 
-	if (isl_basic_set_dim(dom, isl_dim_all) == 0)
-		return basic_map_partial_lexopt_pma(bmap, dom, empty, max);
+	if (isl_basic_set_dim(dom, isl_dim_all) == 0) {
+		res.pma = basic_map_partial_lexopt_pma(bmap, dom, empty, max);
+		return res;
+	}
+
+	compress = get_domain_compression(dom, &morph);
+	if (compress < 0)
+		goto error;
+	if (compress)
+		return basic_map_partial_lexopt_compressed(bmap, dom, morph,
+			    empty, max, 1, &basic_map_partial_lexopt_pw_multi_aff);
 
 	bmap = isl_basic_map_intersect_domain(bmap, isl_basic_set_copy(dom));
 	bmap = isl_basic_map_detect_equalities(bmap);
 	bmap = isl_basic_map_remove_redundancies(bmap);
 
-	return basic_map_partial_lexopt_pma(bmap, dom, empty, max);
+	res.pma = basic_map_partial_lexopt_pma(bmap, dom, empty, max);
+	return res;
 error:
 	isl_basic_set_free(dom);
 	isl_basic_map_free(bmap);
-	return NULL;
+	return res;
+}
+
+/* Compute the lexicographic minimum (or maximum if "max" is set)
+ * of "bmap" over the domain "dom" and return the result as a piecewise
+ * multi-affine expression.
+ * If the lexopt-cache-size option is positive, then the result
+ * is looked up in and stored in the lexopt cache.
+ */
+__isl_give isl_pw_multi_aff *isl_basic_map_partial_lexopt_pw_multi_aff(
+	__isl_take isl_basic_map *bmap, __isl_take isl_basic_set *dom,
+	__isl_give isl_set **empty, int max)
+{
+	if (bmap && bmap->ctx->opt->lexopt_cache_size > 0)
+		return basic_map_partial_lexopt_cached(bmap, dom, empty, max,
+			1, &basic_map_partial_lexopt_pw_multi_aff).pma;
+	return basic_map_partial_lexopt_pw_multi_aff(bmap, dom, empty,
+							max).pma;
 }
@@ -24,6 +24,8 @@
 #include <isl/set.h>
 #include <isl/flow.h>
 #include <isl_constraint_private.h>
+#include <isl_vec_private.h>
+#include <isl_lp_private.h>
 #include <isl/polynomial.h>
 #include <isl/union_set.h>
 #include <isl/union_map.h>
@@ -1199,10 +1201,91 @@ static int test_convex_hull_algo(isl_ctx *ctx, int convex)
 
 static int test_convex_hull(isl_ctx *ctx)
 {
+	int r;
+
 	if (test_convex_hull_algo(ctx, ISL_CONVEX_HULL_FM) < 0)
 		return -1;
 	if (test_convex_hull_algo(ctx, ISL_CONVEX_HULL_WRAP) < 0)
 		return -1;
+	isl_options_set_lp_solver(ctx, ISL_LP_FLOAT);
+	r = test_convex_hull_algo(ctx, ISL_CONVEX_HULL_WRAP);
+	isl_options_set_lp_solver(ctx, ISL_LP_TAB);
+	return r;
+}
+
+static struct {
+	const char *set;
+	const char *obj;
+	int max;
+	enum isl_lp_result res;
+	int opt;
+	int opt_denom;
+} lp_tests[] = {
+	{ "{ [x, y] : 0 <= x <= 10 and 0 <= y and 2y <= x + 1 }",
+	  "{ [x, y] -> [(x + y)] }", 1, isl_lp_ok, 31, 2 },
+	{ "{ [x, y] : 2x + 3y >= 1 and x >= 0 and y >= 0 }",
+	  "{ [x, y] -> [(x + y)] }", 0, isl_lp_ok, 1, 3 },
+	{ "{ [x, y] : x + y = 5 and x >= 0 and y >= 0 }",
+	  "{ [x, y] -> [(x - y)] }", 1, isl_lp_ok, 5, 1 },
+	{ "{ [x, y] : x >= 1 }",
+	  "{ [x, y] -> [(x)] }", 0, isl_lp_ok, 1, 1 },
+	{ "{ [x, y] : x >= 0 }",
+	  "{ [x, y] -> [(x)] }", 1, isl_lp_unbounded, 0, 1 },
+	{ "{ [x] : 2x >= 1 and 2x <= 0 }",
+	  "{ [x] -> [(x)] }", 0, isl_lp_empty, 0, 1 },
+};
+
+/* Check that both LP solvers produce the expected (rational) optima
+ * for the problems in lp_tests.
+ */
+static int test_lp(isl_ctx *ctx)
+{
+	int i, j;
+	int solver[] = { ISL_LP_TAB, ISL_LP_FLOAT };
+	int orig_solver = isl_options_get_lp_solver(ctx);
+	int ok = 1;
+	isl_int opt, opt_denom;
+
+	isl_int_init(opt);
+	isl_int_init(opt_denom);
+	for (i = 0; ok && i < ARRAY_SIZE(solver); ++i) {
+		isl_options_set_lp_solver(ctx, solver[i]);
+		for (j = 0; ok && j < ARRAY_SIZE(lp_tests); ++j) {
+			isl_basic_set *bset;
+			isl_aff *obj;
+			enum isl_lp_result res;
+
+			bset = isl_basic_set_read_from_str(ctx,
+							lp_tests[j].set);
+			obj = isl_aff_read_from_str(ctx, lp_tests[j].obj);
+			if (!bset || !obj)
+				ok = -1;
+			else
+				res = isl_basic_set_solve_lp(bset,
+					    lp_tests[j].max,
+					    obj->v->el + 1, obj->v->el[0],
+					    &opt, &opt_denom, NULL);
+			if (ok > 0 && res != lp_tests[j].res)
+				ok = 0;
+			if (ok > 0 && res == isl_lp_ok) {
+				isl_int_mul_si(opt, opt, lp_tests[j].opt_denom);
+				isl_int_mul_si(opt_denom, opt_denom,
+						lp_tests[j].opt);
+				ok = isl_int_eq(opt, opt_denom);
+			}
+			isl_aff_free(obj);
+			isl_basic_set_free(bset);
+		}
+	}
+	isl_int_clear(opt);
+	isl_int_clear(opt_denom);
+	isl_options_set_lp_solver(ctx, orig_solver);
+
+	if (ok < 0)
+		return -1;
+	if (!ok)
+		isl_die(ctx, isl_error_unknown, "unexpected LP result",
+			return -1);
 	return 0;
 }
 
@@ -1340,6 +1423,83 @@ static int test_gist(struct isl_ctx *ctx)
 	return 0;
 }
 
+/* Compute the gist of "str" with respect to "context" and
+ * check whether the result has "name" as the name
+ * of its first set dimension.
+ */
+static int gist_has_dim_name(isl_ctx *ctx, const char *str,
+	const char *context, const char *name)
+{
+	int equal;
+	const char *dim_name;
+	isl_set *set1, *set2;
+
+	set1 = isl_set_read_from_str(ctx, str);
+	set2 = isl_set_read_from_str(ctx, context);
+	set1 = isl_set_gist(set1, set2);
+	if (!set1)
+		return -1;
+	dim_name = isl_set_get_dim_name(set1, isl_dim_set, 0);
+	equal = dim_name && !strcmp(dim_name, name);
+	isl_set_free(set1);
+
+	return equal;
+}
+
+/* Check that the results of isl_set_gist are the same
+ * when they are taken from the gist cache and that the cache
+ * is actually used when the same gist is computed twice.
+ * Also check that a cached result is not returned for a set
+ * that only differs in the names of its dimensions.
+ */
+static int test_gist_cache(isl_ctx *ctx)
+{
+	int i, j;
+	int size;
+	int equal;
+	long hits;
+
+	size = isl_options_get_gist_cache_size(ctx);
+	isl_options_set_gist_cache_size(ctx, 4);
+	hits = ctx->stats->gist_cache_hits;
+
+	equal = 1;
+	for (i = 0; equal > 0 && i < ARRAY_SIZE(gist_tests); ++i) {
+		for (j = 0; equal > 0 && j < 2; ++j) {
+			isl_set *set1, *set2;
+
+			set1 = isl_set_read_from_str(ctx, gist_tests[i].set);
+			set2 = isl_set_read_from_str(ctx,
+						    gist_tests[i].context);
+			set1 = isl_set_gist(set1, set2);
+			set2 = isl_set_read_from_str(ctx, gist_tests[i].gist);
+			equal = isl_set_is_equal(set1, set2);
+			isl_set_free(set1);
+			isl_set_free(set2);
+		}
+	}
+	if (equal > 0)
+		equal = gist_has_dim_name(ctx, "{ [i] : 0 <= i <= 10 }",
+					"{ [i] : i >= 0 }", "i");
+	if (equal > 0)
+		equal = gist_has_dim_name(ctx, "{ [j] : 0 <= j <= 10 }",
+					"{ [j] : j >= 0 }", "j");
+
+	isl_options_set_gist_cache_size(ctx, size);
+	isl_ctx_clear_gist_cache(ctx);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"incorrect gist result", return -1);
+	if (ctx->stats->gist_cache_hits == hits)
+		isl_die(ctx, isl_error_unknown,
+			"gist cache not used", return -1);
+
+	return 0;
+}
+
 int test_coalesce_set(isl_ctx *ctx, const char *str, int check_one)
 {
 	isl_set *set, *set2;
@@ -2007,6 +2167,16 @@ static int test_lexmin(struct isl_ctx *ctx)
 	isl_map_free(map);
 	isl_map_free(map2);
 
+	/* Check that several non-parametric cuts can be added at once. */
+	str = "[n] -> { [a, b] : 2a >= 2n + 1 and 3b >= 3n + 1 }";
+	set = isl_set_read_from_str(ctx, str);
+	set = isl_set_lexmin(set);
+	str = "[n] -> { [1 + n, 1 + n] }";
+	set2 = isl_set_read_from_str(ctx, str);
+	assert(isl_set_is_equal(set, set2));
+	isl_set_free(set);
+	isl_set_free(set2);
+
 	/* Check that empty pieces are properly combined. */
 	str = "[K, N] -> { [x, y] -> [a, b] : K+2<=N<=K+4 and x>=4 and "
 		"2N-6<=x<K+N and N-1<=a<=K+N-1 and N+b-6<=a<=2N-4 and "
@@ -2039,6 +2209,157 @@ static int test_lexmin(struct isl_ctx *ctx)
 	return 0;
 }
 
+/* Inputs for test_pip_compress.
+ * Each input consists of a basic map and a domain with equality
+ * constraints involving the domain variables.
+ */
+struct {
+	const char *bmap;
+	const char *dom;
+} pip_compress_tests[] = {
+	{ "[n] -> { [i, j] -> [k] : 0 <= k <= n and i + j <= k }",
+	  "[n] -> { [i, j] : j = i + 1 and 0 <= i <= n }" },
+	{ "[n, m] -> { [i, j, l] -> [a, b] : 0 <= a <= l and "
+		"a + b >= i and 0 <= b <= m + j }",
+	  "[n, m] -> { [i, j, l] : i = n + 2j and l = i - j and j >= 0 }" },
+	{ "{ [i, j] -> [k] : 2k >= i + j and k <= 10 }",
+	  "{ [i, j] : 2i = 3j and 0 <= j <= 20 }" },
+	{ "[n] -> { [i] -> [k] : 0 <= k <= n and k >= i }",
+	  "[n] -> { [i] : 2i = n and n >= 0 }" },
+};
+
+/* Compute the lexicographic minimum (or maximum if "max" is set)
+ * of the basic map described by "bmap_str" over the domain
+ * described by "dom_str", both as a map and as a piecewise
+ * multi-affine expression, with the compression of
+ * the domain variables enabled and
+ * check that the results are the same as without compression.
+ */
+static int test_pip_compress_case(isl_ctx *ctx, const char *bmap_str,
+	const char *dom_str, int max)
+{
+	isl_basic_map *bmap;
+	isl_basic_set *dom;
+	isl_pw_multi_aff *pma;
+	isl_map *map, *ref, *map_pma;
+	isl_set *set, *empty, *ref_empty;
+	int equal;
+
+	isl_options_set_pip_compress(ctx, 0);
+	bmap = isl_basic_map_read_from_str(ctx, bmap_str);
+	dom = isl_basic_set_read_from_str(ctx, dom_str);
+	ref = max ? isl_basic_map_partial_lexmax(bmap, dom, &ref_empty) :
+		    isl_basic_map_partial_lexmin(bmap, dom, &ref_empty);
+
+	isl_options_set_pip_compress(ctx, 1);
+	bmap = isl_basic_map_read_from_str(ctx, bmap_str);
+	dom = isl_basic_set_read_from_str(ctx, dom_str);
+	map = isl_map_from_basic_map(isl_basic_map_copy(bmap));
+	set = isl_set_from_basic_set(isl_basic_set_copy(dom));
+	map = max ? isl_map_partial_lexmax(map, set, &empty) :
+		    isl_map_partial_lexmin(map, set, &empty);
+	pma = max ? isl_basic_map_partial_lexmax_pw_multi_aff(bmap, dom, NULL) :
+		    isl_basic_map_partial_lexmin_pw_multi_aff(bmap, dom, NULL);
+	map_pma = isl_map_from_pw_multi_aff(pma);
+
+	equal = isl_map_is_equal(map, ref);
+	if (equal > 0)
+		equal = isl_map_is_equal(map_pma, ref);
+	if (equal > 0)
+		equal = isl_set_is_equal(empty, ref_empty);
+
+	isl_map_free(map);
+	isl_map_free(map_pma);
+	isl_map_free(ref);
+	isl_set_free(empty);
+	isl_set_free(ref_empty);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"incorrect result with compressed domain", return -1);
+
+	return 0;
+}
+
+/* Compute the partial lexicographic minimum of the map described
+ * by "map_str" over the set described by "dom_str" and check
+ * whether the result has "name1" and "name2" as the names
+ * of its first two input dimensions.
+ */
+static int partial_lexmin_has_dim_names(isl_ctx *ctx, const char *map_str,
+	const char *dom_str, const char *name1, const char *name2)
+{
+	int equal;
+	const char *name;
+	isl_map *map;
+	isl_set *dom;
+
+	map = isl_map_read_from_str(ctx, map_str);
+	dom = isl_set_read_from_str(ctx, dom_str);
+	map = isl_map_partial_lexmin(map, dom, NULL);
+	if (!map)
+		return -1;
+	name = isl_map_get_dim_name(map, isl_dim_in, 0);
+	equal = name && !strcmp(name, name1);
+	name = isl_map_get_dim_name(map, isl_dim_in, 1);
+	equal = equal && name && !strcmp(name, name2);
+	isl_map_free(map);
+
+	return equal;
+}
+
+/* Check that compressing the domain variables does not affect
+ * the lexicographic optima of the inputs in pip_compress_tests.
+ * Since each problem is solved several times over the same domain,
+ * the compression should be reused.
+ * Also check that the compression is not reused for a domain
+ * that only differs in the names of its dimensions.
+ */
+static int test_pip_compress(isl_ctx *ctx)
+{
+	int i, max;
+	int compress;
+	int r, names;
+	long hits;
+
+	compress = isl_options_get_pip_compress(ctx);
+	hits = ctx->stats->pip_compression_hits;
+
+	r = 0;
+	for (i = 0; r >= 0 && i < ARRAY_SIZE(pip_compress_tests); ++i)
+		for (max = 0; r >= 0 && max < 2; ++max)
+			r = test_pip_compress_case(ctx,
+				pip_compress_tests[i].bmap,
+				pip_compress_tests[i].dom, max);
+
+	names = 1;
+	if (r >= 0)
+		names = partial_lexmin_has_dim_names(ctx,
+			"[n] -> { [i, k] -> [o] : i <= o <= n }",
+			"[n] -> { [i, k] : k = i + 1 and 0 <= i }", "i", "k");
+	if (r >= 0 && names > 0)
+		names = partial_lexmin_has_dim_names(ctx,
+			"[n] -> { [x, y] -> [o] : x <= o <= n }",
+			"[n] -> { [x, y] : y = x + 1 and 0 <= x }", "x", "y");
+
+	isl_options_set_pip_compress(ctx, compress);
+	isl_ctx_clear_pip_compression(ctx);
+
+	if (r < 0 || names < 0)
+		return -1;
+	if (ctx->stats->pip_compression_hits == hits)
+		isl_die(ctx, isl_error_unknown,
+			"domain compression not reused", return -1);
+	if (!names)
+		isl_die(ctx, isl_error_unknown,
+			"result of compressed domain has wrong names",
+			return -1);
+
+	return 0;
+}
+
 /* Check that isl_set_min_val and isl_set_max_val compute the correct
  * result on non-convex inputs.
  */
@@ -2072,6 +2393,96 @@ static int test_min(struct isl_ctx *ctx)
 	return 0;
 }
 
+/* Inputs for isl_set_min_val and isl_set_max_val tests
+ * comparing the results of the different ILP solvers.
+ */
+struct {
+	const char *set;
+	const char *obj;
+} ilp_solver_tests[] = {
+	{ "{ [x, y] : 0 <= x <= 100 and 0 <= y <= 100 and 3x + 5y <= 247 }",
+	  "{ [x, y] -> [2x + 3y] }" },
+	{ "{ [a, b, c] : a, b, c >= 0 and 13a + 17b + 19c <= 1000 }",
+	  "{ [a, b, c] -> [14a + 18b + 21c] }" },
+	{ "{ [x, y] : 0 <= x <= 10 and 0 <= y <= 10 and 1 <= 3x - 3y <= 2 }",
+	  "{ [x, y] -> [x + y] }" },
+	{ "{ [x] : 0 <= x <= 100 and x mod 7 >= 3 }",
+	  "{ [x] -> [x] }" },
+	{ "{ [x, y] : x = 3y + 1 and 0 <= x <= 100 }",
+	  "{ [x, y] -> [x - y] }" },
+	{ "{ [x, y] : x >= 0 and 1 <= 3x - 3y <= 2 }",
+	  "{ [x, y] -> [x - y] }" },
+	{ "{ [x, y] : x >= 0 and y >= x }",
+	  "{ [x, y] -> [y - 2x] }" },
+	{ "{ [x, y] : 0 <= x, y <= 1000 and 2 <= 7x + 11y <= 5000 and "
+	    "x <= 3y and 2y <= 9x }",
+	  "{ [x, y] -> [5x + 8y] }" },
+};
+
+/* Compute the minimum (or maximum if "max" is set) of the objective
+ * described by "obj_str" over the set described by "set_str"
+ * with both ILP solvers and check that the results are the same.
+ */
+static int test_ilp_solver_case(isl_ctx *ctx, const char *set_str,
+	const char *obj_str, int max)
+{
+	isl_set *set;
+	isl_aff *obj;
+	isl_val *ref, *val;
+	int equal;
+
+	set = isl_set_read_from_str(ctx, set_str);
+	obj = isl_aff_read_from_str(ctx, obj_str);
+
+	isl_options_set_ilp_solver(ctx, ISL_ILP_SEARCH);
+	ref = max ? isl_set_max_val(set, obj) : isl_set_min_val(set, obj);
+	isl_options_set_ilp_solver(ctx, ISL_ILP_BB);
+	val = max ? isl_set_max_val(set, obj) : isl_set_min_val(set, obj);
+
+	if (!ref || !val)
+		equal = -1;
+	else if (isl_val_is_nan(ref))
+		equal = isl_val_is_nan(val);
+	else
+		equal = isl_val_eq(ref, val);
+
+	isl_val_free(ref);
+	isl_val_free(val);
+	isl_aff_free(obj);
+	isl_set_free(set);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"ILP solvers produce different results", return -1);
+
+	return 0;
+}
+
+/* Check that the branch-and-bound ILP solver computes the same
+ * optimal values as the default ILP solver on the inputs
+ * in ilp_solver_tests.
+ */
+static int test_ilp_solver(isl_ctx *ctx)
+{
+	int i, max;
+	int solver;
+	int r;
+
+	solver = isl_options_get_ilp_solver(ctx);
+
+	r = 0;
+	for (i = 0; r >= 0 && i < ARRAY_SIZE(ilp_solver_tests); ++i)
+		for (max = 0; r >= 0 && max < 2; ++max)
+			r = test_ilp_solver_case(ctx, ilp_solver_tests[i].set,
+						ilp_solver_tests[i].obj, max);
+
+	isl_options_set_ilp_solver(ctx, solver);
+
+	return r;
+}
+
 struct must_may {
 	isl_map *must;
 	isl_map *may;
@@ -2740,6 +3151,33 @@ static int test_subset(isl_ctx *ctx)
 	return 0;
 }
 
+/* Set differences where some of the basic sets of the subtrahend
+ * have a bounding box that is disjoint from that of the minuend.
+ * These basic sets are skipped during the computation,
+ * which should not affect the result.
+ */
+struct {
+	const char *minuend;
+	const char *subtrahend;
+	const char *difference;
+} subtract_tests[] = {
+	{ "{ [i] : 0 <= i <= 10 }", "{ [-3]; [i] : 5 <= i <= 7; [20] }",
+	  "{ [i] : 0 <= i <= 4 or 8 <= i <= 10 }" },
+	{ "{ [i, j] : 0 <= i, j <= 10 }",
+	  "{ [i, j] : 20 <= i <= 30 and 0 <= j <= 10; "
+	    "[i, j] : 0 <= i <= 10 and 20 <= j <= 30; "
+	    "[i, j] : 5 <= i <= 15 and 0 <= j <= 10 }",
+	  "{ [i, j] : 0 <= i <= 4 and 0 <= j <= 10 }" },
+	{ "{ [i] : 0 <= i <= 10 }",
+	  "{ [i] : exists (a : i = 2a and 20 <= i <= 30); [i] : i >= 5 }",
+	  "{ [i] : 0 <= i <= 4 }" },
+	{ "{ [i] : 0 <= i <= 10 }", "{ [i] : i >= 20 and i <= 10 }",
+	  "{ [i] : 0 <= i <= 10 }" },
+	{ "{ [i] : 0 <= i <= 10; [i] : 20 <= i <= 30 }",
+	  "{ [i] : 8 <= i <= 22; [i] : i >= 40 }",
+	  "{ [i] : 0 <= i <= 7 or 23 <= i <= 30 }" },
+};
+
 struct {
 	const char *minuend;
 	const char *subtrahend;
@@ -2756,8 +3194,24 @@ static int test_subtract(isl_ctx *ctx)
 	isl_union_map *umap1, *umap2;
 	isl_union_pw_multi_aff *upma1, *upma2;
 	isl_union_set *uset;
+	isl_set *set1, *set2, *diff;
 	int equal;
 
+	for (i = 0; i < ARRAY_SIZE(subtract_tests); ++i) {
+		set1 = isl_set_read_from_str(ctx, subtract_tests[i].minuend);
+		set2 = isl_set_read_from_str(ctx, subtract_tests[i].subtrahend);
+		diff = isl_set_read_from_str(ctx, subtract_tests[i].difference);
+		set1 = isl_set_subtract(set1, set2);
+		equal = isl_set_is_equal(set1, diff);
+		isl_set_free(set1);
+		isl_set_free(diff);
+		if (equal < 0)
+			return -1;
+		if (!equal)
+			isl_die(ctx, isl_error_unknown,
+				"incorrect subtract result", return -1);
+	}
+
 	for (i = 0; i < ARRAY_SIZE(subtract_domain_tests); ++i) {
 		umap1 = isl_union_map_read_from_str(ctx,
 				subtract_domain_tests[i].minuend);
@@ -3059,6 +3513,65 @@ int test_special_schedule(isl_ctx *ctx, const char *domain,
 	return 0;
 }
 
+/* Check that enabling the schedule coefficient cache does not affect
+ * the computed schedule, also when the same schedule is computed twice
+ * and when the cache overflows.
+ */
+static int test_schedule_coefficient_cache(isl_ctx *ctx)
+{
+	const char *D, *V, *P, *S;
+	int size;
+	int i, r = 0;
+
+	D = "[N] -> { S0[i, j] : 0 <= i, j < N; S1[i, j] : 0 <= i, j < N }";
+	V = "[N] -> { S0[i, j] -> S1[i, j]; S0[i, j] -> S0[i + 1, j]; "
+		"S1[i, j] -> S1[i, j + 1] }";
+	P = V;
+	S = "[N] -> { S0[i, j] -> [i, j, 0]; S1[i, j] -> [i, j, 1] }";
+
+	size = isl_options_get_schedule_coefficient_cache(ctx);
+	isl_options_set_schedule_coefficient_cache(ctx, 2);
+	for (i = 0; r >= 0 && i < 2; ++i)
+		r = test_special_schedule(ctx, D, V, P, S);
+	isl_options_set_schedule_coefficient_cache(ctx, size);
+
+	return r;
+}
+
+/* Check that the duals of the dependence relations computed
+ * for a dependence graph are reused by the subgraphs
+ * in which the schedule computation is continued.
+ * The dependence graph below is split into components after
+ * the outer band has been computed.  Each of the four dependence
+ * relations should then only require a single computation
+ * of its dual, while the computed schedule should not be affected.
+ */
+static int test_schedule_sub_coefficients(isl_ctx *ctx)
+{
+	const char *D, *V, *P, *S;
+	long hits, misses;
+
+	D = "[N] -> { S0[i] : 0 <= i < N; S1[i] : 0 <= i < N; "
+		"S2[i] : 0 <= i < N }";
+	V = "[N] -> { S0[i] -> S1[N - 1 - i]; S0[i] -> S0[i + 1]; "
+		"S1[i] -> S1[i + 1]; S1[i] -> S2[i] }";
+	P = V;
+	S = "[N] -> { S0[i] -> [0, i]; S1[i] -> [1, i]; S2[i] -> [2, i] }";
+
+	hits = ctx->stats->schedule_coef_hits;
+	misses = ctx->stats->schedule_coef_misses;
+	if (test_special_schedule(ctx, D, V, P, S) < 0)
+		return -1;
+	if (ctx->stats->schedule_coef_hits == hits)
+		isl_die(ctx, isl_error_unknown,
+			"duals not reused", return -1);
+	if (ctx->stats->schedule_coef_misses - misses > 4)
+		isl_die(ctx, isl_error_unknown,
+			"duals recomputed in subgraph", return -1);
+
+	return 0;
+}
+
 /* Check that the schedule map is properly padded, even after being
  * reconstructed from the band forest.
  */
@@ -3676,6 +4189,12 @@ int test_schedule(isl_ctx *ctx)
 	if (test_padded_schedule(ctx) < 0)
 		return -1;
 
+	if (test_schedule_coefficient_cache(ctx) < 0)
+		return -1;
+
+	if (test_schedule_sub_coefficients(ctx) < 0)
+		return -1;
+
 	/* Check that check for progress is not confused by rational
 	 * solution.
 	 */
@@ -4414,6 +4933,37 @@ int test_output(isl_ctx *ctx)
 	return 0;
 }
 
+/* Check that the sample point of a basic set is reused
+ * after intersecting it with a basic set that has an extra div.
+ * The sample point computed by isl_basic_set_is_empty
+ * is the origin, which also satisfies the extra constraints.
+ */
+static int test_sample_lift(isl_ctx *ctx)
+{
+	isl_basic_set *bset1, *bset2;
+	int empty, has_sample;
+
+	bset1 = isl_basic_set_read_from_str(ctx, "{ [i] : 0 <= i <= 10 }");
+	empty = isl_basic_set_is_empty(bset1);
+	bset2 = isl_basic_set_read_from_str(ctx, "{ [i] : i mod 2 = 0 }");
+	bset1 = isl_basic_set_intersect(bset1, bset2);
+	if (empty < 0 || !bset1) {
+		isl_basic_set_free(bset1);
+		return -1;
+	}
+	has_sample = bset1->sample &&
+		    bset1->sample->size == 1 + isl_basic_set_total_dim(bset1);
+	isl_basic_set_free(bset1);
+	if (empty)
+		isl_die(ctx, isl_error_unknown, "unexpected empty set",
+			return -1);
+	if (!has_sample)
+		isl_die(ctx, isl_error_unknown, "sample point not reused",
+			return -1);
+
+	return 0;
+}
+
 int test_sample(isl_ctx *ctx)
 {
 	const char *str;
@@ -5543,6 +6093,177 @@ static int test_compute_divs(isl_ctx *ctx)
 	return 0;
 }
 
+/* Inputs for test_lexopt_cache.
+ */
+const char *lexopt_cache_tests[] = {
+	"[n] -> { [i] -> [j] : 0 <= j <= n and i <= j }",
+	"{ [i, j] -> [k] : 2k >= i + j and k <= 10 and 0 <= i, j <= 20 }",
+	"[n, m] -> { [i] -> [a, b] : 0 <= a <= n and a + b >= i and b <= m }",
+};
+
+/* Is the lexicographic minimum (or maximum if "max" is set)
+ * of the map described by "str" equal to "ref", when computed
+ * as a map, as a piecewise multi-affine expression and
+ * over the domain of the map, and is the part of the domain
+ * without solutions equal to "ref_empty" in the latter case?
+ */
+static isl_bool lexopt_is_equal(isl_ctx *ctx, const char *str, int max,
+	__isl_keep isl_map *ref, __isl_keep isl_set *ref_empty)
+{
+	isl_map *map, *opt;
+	isl_set *dom, *empty;
+	isl_pw_multi_aff *pma;
+	isl_bool equal, equal_empty;
+
+	map = isl_map_read_from_str(ctx, str);
+	opt = max ? isl_map_lexmax(isl_map_copy(map)) :
+		    isl_map_lexmin(isl_map_copy(map));
+	equal = isl_map_is_equal(opt, ref);
+	isl_map_free(opt);
+	if (equal < 0 || !equal) {
+		isl_map_free(map);
+		return equal;
+	}
+
+	pma = max ? isl_map_lexmax_pw_multi_aff(isl_map_copy(map)) :
+		    isl_map_lexmin_pw_multi_aff(isl_map_copy(map));
+	opt = isl_map_from_pw_multi_aff(pma);
+	equal = isl_map_is_equal(opt, ref);
+	isl_map_free(opt);
+	if (equal < 0 || !equal) {
+		isl_map_free(map);
+		return equal;
+	}
+
+	dom = isl_map_domain(isl_map_copy(map));
+	opt = max ? isl_map_partial_lexmax(map, dom, &empty) :
+		    isl_map_partial_lexmin(map, dom, &empty);
+	equal = isl_map_is_equal(opt, ref);
+	equal_empty = isl_set_is_equal(empty, ref_empty);
+	isl_map_free(opt);
+	isl_set_free(empty);
+
+	if (equal < 0 || equal_empty < 0)
+		return isl_bool_error;
+	return equal && equal_empty;
+}
+
+/* Compute the lexicographic minimum (or maximum if "max" is set)
+ * of the map described by "str" without the lexopt cache and
+ * check that the same results are obtained twice in different forms
+ * with the lexopt cache.
+ */
+static int test_lexopt_cache_map(isl_ctx *ctx, const char *str, int max)
+{
+	int i;
+	isl_bool equal;
+	isl_map *map, *ref;
+	isl_set *dom, *ref_empty;
+
+	isl_options_set_lexopt_cache_size(ctx, 0);
+	map = isl_map_read_from_str(ctx, str);
+	dom = isl_map_domain(isl_map_copy(map));
+	ref = max ? isl_map_partial_lexmax(map, dom, &ref_empty) :
+		    isl_map_partial_lexmin(map, dom, &ref_empty);
+
+	isl_options_set_lexopt_cache_size(ctx, 4);
+	equal = isl_bool_true;
+	for (i = 0; equal == isl_bool_true && i < 2; ++i)
+		equal = lexopt_is_equal(ctx, str, max, ref, ref_empty);
+
+	isl_map_free(ref);
+	isl_set_free(ref_empty);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown,
+			"incorrect lexopt result", return -1);
+
+	return 0;
+}
+
+/* Compute the lexicographic minimum of the map described by "str"
+ * and check whether the result has "in" and "out" as the names
+ * of its first input and output dimension.
+ */
+static int lexmin_has_dim_names(isl_ctx *ctx, const char *str,
+	const char *in, const char *out)
+{
+	int equal;
+	const char *name_in, *name_out;
+	isl_map *map;
+
+	map = isl_map_read_from_str(ctx, str);
+	map = isl_map_lexmin(map);
+	if (!map)
+		return -1;
+	name_in = isl_map_get_dim_name(map, isl_dim_in, 0);
+	name_out = isl_map_get_dim_name(map, isl_dim_out, 0);
+	equal = name_in && !strcmp(name_in, in) &&
+		name_out && !strcmp(name_out, out);
+	isl_map_free(map);
+
+	return equal;
+}
+
+/* Check that the lexicographic optima of the inputs
+ * in lexopt_cache_tests are the same with and without the lexopt cache
+ * and that the cache is being used.
+ * Also check that a cached result is not returned for a map
+ * that only differs in the names of its dimensions.
+ * Also run some tests that perform lexicographic optimization
+ * internally with the cache enabled, since the results
+ * of the computation may then be reused by these internal callers.
+ */
+static int test_lexopt_cache(isl_ctx *ctx)
+{
+	int i, max;
+	int size;
+	int r, names;
+	long hits;
+
+	size = isl_options_get_lexopt_cache_size(ctx);
+	hits = ctx->stats->lexopt_cache_hits;
+
+	r = 0;
+	for (i = 0; r >= 0 && i < ARRAY_SIZE(lexopt_cache_tests); ++i)
+		for (max = 0; r >= 0 && max < 2; ++max)
+			r = test_lexopt_cache_map(ctx, lexopt_cache_tests[i],
+						    max);
+
+	isl_options_set_lexopt_cache_size(ctx, 16);
+	for (i = 0; r >= 0 && i < 2; ++i) {
+		r = test_lexmin(ctx);
+		if (r >= 0)
+			r = test_partial_lexmin(ctx);
+		if (r >= 0)
+			r = test_compute_divs(ctx);
+	}
+
+	names = 1;
+	if (r >= 0)
+		names = lexmin_has_dim_names(ctx,
+			"[n] -> { [i] -> [o] : i <= o <= n }", "i", "o");
+	if (r >= 0 && names > 0)
+		names = lexmin_has_dim_names(ctx,
+			"[n] -> { [j] -> [p] : j <= p <= n }", "j", "p");
+
+	isl_options_set_lexopt_cache_size(ctx, size);
+	isl_ctx_clear_lexopt_cache(ctx);
+
+	if (r < 0 || names < 0)
+		return -1;
+	if (ctx->stats->lexopt_cache_hits == hits)
+		isl_die(ctx, isl_error_unknown,
+			"lexopt cache not used", return -1);
+	if (!names)
+		isl_die(ctx, isl_error_unknown,
+			"lexopt result has wrong names", return -1);
+
+	return 0;
+}
+
 /* Check that the reaching domain elements and the prefix schedule
  * at a leaf node are the same before and after grouping.
  */
@@ -5885,6 +6606,121 @@ static int test_tile(isl_ctx *ctx)
 	return 0;
 }
 
+/* Does the block cache of "ctx" hold more than ISL_BLK_CACHE_SIZE blocks
+ * in any size class?
+ */
+static int block_cache_exceeds_default(isl_ctx *ctx)
+{
+	int c;
+
+	for (c = 0; c < ISL_BLK_N_CLASS; ++c)
+		if (ctx->n_cached[c] > ISL_BLK_CACHE_SIZE)
+			return 1;
+	return 0;
+}
+
+/* Check that an object created inside a region remains valid
+ * after the region is left and that the memory blocks
+ * kept around inside the region are released when it is left.
+ * Also check that more than ISL_BLK_CACHE_SIZE blocks of the same size
+ * are in fact kept around inside the region.
+ */
+static int test_region(isl_ctx *ctx)
+{
+	int i;
+	int empty, kept;
+	const char *str;
+	isl_set *set, *set2;
+	isl_vec *vec[ISL_BLK_CACHE_SIZE + 1];
+
+	str = "{ [i, j] : 0 <= i < 10 and 0 <= j < 10 and i != j }";
+	if (isl_ctx_push_region(ctx) < 0)
+		return -1;
+	if (isl_ctx_push_region(ctx) < 0)
+		return -1;
+	set = isl_set_read_from_str(ctx, str);
+	set = isl_set_coalesce(set);
+	for (i = 0; i < ARRAY_SIZE(vec); ++i)
+		vec[i] = isl_vec_alloc(ctx, 8);
+	for (i = 0; i < ARRAY_SIZE(vec); ++i)
+		isl_vec_free(vec[i]);
+	kept = block_cache_exceeds_default(ctx);
+	if (isl_ctx_pop_region(ctx) < 0)
+		set = isl_set_free(set);
+	set2 = isl_set_read_from_str(ctx, str);
+	set = isl_set_subtract(set, isl_set_copy(set2));
+	if (isl_ctx_pop_region(ctx) < 0)
+		set = isl_set_free(set);
+	empty = isl_set_is_empty(set);
+	isl_set_free(set);
+	isl_set_free(set2);
+
+	if (empty < 0)
+		return -1;
+	if (!empty)
+		isl_die(ctx, isl_error_unknown, "unexpected result", return -1);
+	if (!kept)
+		isl_die(ctx, isl_error_unknown,
+			"no extra blocks kept inside region", return -1);
+	if (block_cache_exceeds_default(ctx))
+		isl_die(ctx, isl_error_unknown,
+			"block cache not trimmed", return -1);
+
+	return 0;
+}
+
+/* Check that identical basic sets are shared after normalization
+ * when the share-basic-maps option is set and that modifying
+ * one of the sets does not affect the other.
+ */
+static int test_share(isl_ctx *ctx)
+{
+	int share;
+	int equal, same;
+	isl_set *set1, *set2;
+
+	share = isl_options_get_share_basic_maps(ctx);
+	isl_options_set_share_basic_maps(ctx, 1);
+
+	set1 = isl_set_read_from_str(ctx, "{ [i, j] : 0 <= i, j < 10 }");
+	set2 = isl_set_read_from_str(ctx,
+				"{ [i, j] : j <= 9 and i <= 9 and i, j >= 0 }");
+	equal = isl_set_plain_is_equal(set1, set2);
+	same = equal > 0 && set1->p[0] == set2->p[0];
+	set1 = isl_set_fix_si(set1, isl_dim_set, 0, 5);
+	set2 = isl_set_normalize(set2);
+	if (set1 && set2 && set1->p[0] == set2->p[0])
+		same = 0;
+	isl_set_free(set1);
+	isl_set_free(set2);
+
+	set1 = isl_set_read_from_str(ctx, "{ [i] : 0 <= i <= 10 }");
+	set2 = isl_set_read_from_str(ctx, "{ [j] : 0 <= j <= 10 }");
+	set1 = isl_set_normalize(set1);
+	set2 = isl_set_normalize(set2);
+	if (!set1 || !set2)
+		same = 0;
+	else if (set1->p[0] == set2->p[0])
+		same = 0;
+	else if (strcmp(isl_set_get_dim_name(set2, isl_dim_set, 0), "j"))
+		same = 0;
+	isl_set_free(set1);
+	isl_set_free(set2);
+
+	isl_options_set_share_basic_maps(ctx, share);
+
+	if (equal < 0)
+		return -1;
+	if (!equal)
+		isl_die(ctx, isl_error_unknown, "sets should be equal",
+			return -1);
+	if (!same)
+		isl_die(ctx, isl_error_unknown, "unexpected sharing",
+			return -1);
+
+	return 0;
+}
+
 struct {
 	const char *name;
 	int (*fn)(isl_ctx *ctx);
@@ -5912,10 +6748,12 @@ struct {
 	{ "slice", &test_slice },
 	{ "fixed power", &test_fixed_power },
 	{ "sample", &test_sample },
+	{ "sample lift", &test_sample_lift },
 	{ "output", &test_output },
 	{ "vertices", &test_vertices },
 	{ "fixed", &test_fixed },
 	{ "equal", &test_equal },
+	{ "share", &test_share },
 	{ "disjoint", &test_disjoint },
 	{ "product", &test_product },
 	{ "dim_max", &test_dim_max },
@@ -5932,9 +6770,14 @@ struct {
 	{ "factorize", &test_factorize },
 	{ "subset", &test_subset },
 	{ "subtract", &test_subtract },
+	{ "region", &test_region },
 	{ "lexmin", &test_lexmin },
+	{ "lexopt cache", &test_lexopt_cache },
+	{ "pip compress", &test_pip_compress },
 	{ "min", &test_min },
+	{ "ilp solver", &test_ilp_solver },
 	{ "gist", &test_gist },
+	{ "gist cache", &test_gist_cache },
 	{ "piecewise quasi-polynomials", &test_pwqp },
 	{ "lift", &test_lift },
 	{ "bound", &test_bound },
@@ -5948,6 +6791,7 @@ struct {
 	{ "construction", &test_construction },
 	{ "dimension manipulation", &test_dim },
 	{ "map application", &test_application },
+	{ "lp", &test_lp },
 	{ "convex hull", &test_convex_hull },
 	{ "transitive closure", &test_closure },
 };
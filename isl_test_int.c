@@ -54,6 +54,10 @@ struct {
 	{ &int_test_hash, "-2147483647" },
 	{ &int_test_hash, "2147483648" },
 	{ &int_test_hash, "-2147483648" },
+	{ &int_test_hash, "4611686018427387903" },
+	{ &int_test_hash, "-4611686018427387903" },
+	{ &int_test_hash, "4611686018427387904" },
+	{ &int_test_hash, "-4611686018427387904" },
 };
 
 static void int_test_single_value()
@@ -285,6 +289,13 @@ static void int_test_mul(isl_int expected, isl_int lhs, isl_int rhs)
 		assert(isl_int_eq(expected, result));
 	}
 
+	isl_int_set_si(result, 0);
+	isl_int_addmul(result, lhs, rhs);
+	assert(isl_int_eq(expected, result));
+
+	isl_int_submul(result, lhs, rhs);
+	assert(isl_int_is_zero(result));
+
 	isl_int_clear(result);
 }
 
@@ -479,6 +490,11 @@ struct {
 	{ &int_test_sum, "2147483648", "2147483647", "1" },
 	{ &int_test_sum, "-2147483648", "-2147483647", "-1" },
 
+	{ &int_test_sum, "4611686018427387904", "4611686018427387903", "1" },
+	{ &int_test_sum, "-4611686018427387904", "-4611686018427387903", "-1" },
+	{ &int_test_sum, "9223372036854775806",
+	  "4611686018427387903", "4611686018427387903" },
+
 	{ &int_test_product, "0", "0", "0" },
 	{ &int_test_product, "0", "0", "1" },
 	{ &int_test_product, "1", "1", "1" },
@@ -505,6 +521,18 @@ struct {
 	{ &int_test_product,
 	  "4611686016279904256", "-2147483647", "-2147483648" },
 
+	{ &int_test_product,
+	  "4611686018427387904", "2147483648", "2147483648" },
+	{ &int_test_product,
+	  "-4611686018427387904", "-2147483648", "2147483648" },
+
+	{ &int_test_product, "21267647932558653957237540927630737409",
+	  "4611686018427387903", "4611686018427387903" },
+	{ &int_test_product, "-21267647932558653957237540927630737409",
+	  "-4611686018427387903", "4611686018427387903" },
+	{ &int_test_product, "21267647932558653961849226946058125312",
+	  "4611686018427387903", "4611686018427387904" },
+
 	{ &int_test_product, "85070591730234615847396907784232501249",
 	  "9223372036854775807", "9223372036854775807" },
 	{ &int_test_product, "-85070591730234615847396907784232501249",
@@ -568,6 +596,10 @@ struct {
 	{ &int_test_lcm, "15032385529", "7", "2147483647" },
 	{ &int_test_gcd, "2", "6", "-2147483648" },
 	{ &int_test_lcm, "6442450944", "6", "-2147483648" },
+	{ &int_test_gcd, "1", "2", "4611686018427387903" },
+	{ &int_test_lcm, "9223372036854775806", "2", "4611686018427387903" },
+	{ &int_test_gcd, "3", "6", "4611686018427387903" },
+	{ &int_test_lcm, "9223372036854775806", "6", "4611686018427387903" },
 	{ &int_test_gcd, "1", "6", "9223372036854775807" },
 	{ &int_test_lcm, "55340232221128654842", "6", "9223372036854775807" },
 	{ &int_test_gcd, "2", "6", "-9223372036854775808" },
@@ -10,8 +10,12 @@ const char *isl_version(void)
 #ifdef USE_IMATH_FOR_MP
 	"-IMath"
 #ifdef USE_SMALL_INT_OPT
+#ifdef USE_SMALL_INT64_OPT
+	"-64"
+#else
 	"-32"
 #endif
+#endif
 #endif
 	"\n";
 }